@@ -0,0 +1,352 @@
+/**
+ * @file bench_suite.cpp
+ * @brief Общий набор замеров производительности всех шифров с выводом в JSON.
+ *
+ * Для `modAlphaCipher` (laba4_chast1), `modPermutationCipher` (laba4_chast2)
+ * и `modAlphakey` (laba1_chast2) замеряются шифрование и расшифрование
+ * при разных размерах сообщения (16 Б … 256 МБ), длинах ключа (1 … 4096)
+ * и алфавитах текста.
+ *
+ * @details
+ * Каждый вызов замеряется отдельно; по выборке считаются перцентили задержки
+ * (p50, p90, p99), а пропускная способность — по медиане. Формат вывода повторяет
+ * JSON Google Benchmark (`context` и массив `benchmarks`) с дополнительными полями
+ * перцентилей, поэтому результаты можно сравнивать теми же скриптами.
+ *
+ * Параметры командной строки:
+ * - `--filter=СТРОКА` — запускать только замеры, в имени которых есть подстрока;
+ * - `--max-size=БАЙТ` — пропускать сообщения больше заданного размера;
+ * - `--min-time=СЕК` — минимальное время замера одного случая (по умолчанию 0.1).
+ *
+ * Замеры `КЛАСС/shared/threads:N` (N = 1 … 64) проверяют масштабирование: один
+ * константный объект шифра используется одновременно из N потоков, каждый поток
+ * шифрует свой буфер размером `sharedWork`. Размер замера — N × `sharedWork`,
+ * поэтому при линейном масштабировании задержка не растёт с числом потоков.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "modAlphakey.h"
+#include "modGronsfeld.h"
+#include "modPermutation.h"
+#include "shiftKernel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+volatile char sink; /**< Не даёт компилятору выбросить результат шифрования. */
+
+constexpr size_t sharedWork = 1 << 20; /**< Байт на поток в замерах масштабирования. */
+
+/**
+ * @brief Настройки запуска из командной строки.
+ */
+struct Options {
+    std::string filter;             /**< Подстрока имени замера. */
+    size_t maxSize = size_t(256) << 20; /**< Наибольший размер сообщения в байтах. */
+    double minTime = 0.1;           /**< Минимальное время замера одного случая, с. */
+};
+
+/**
+ * @brief Результат одного замера.
+ */
+struct Result {
+    std::string name;  /**< Имя в стиле Google Benchmark: `класс/операция/алфавит/size:N/key:N`. */
+    size_t iterations; /**< Число замеренных вызовов. */
+    size_t bytes;      /**< Размер сообщения в байтах. */
+    double minNs;      /**< Наименьшая задержка. */
+    double meanNs;     /**< Средняя задержка. */
+    double p50Ns;      /**< Медиана задержки. */
+    double p90Ns;      /**< 90-й перцентиль задержки. */
+    double p99Ns;      /**< 99-й перцентиль задержки. */
+};
+
+/**
+ * @brief Вызывает `run` до истечения `minTime` (не менее 3 и не более 100000 раз) и считает статистику.
+ */
+Result measure(const std::string& name, size_t bytes, double minTime, const std::function<void()>& run) {
+    std::vector<double> samples;
+    double total = 0;
+    while ((total < minTime * 1e9 || samples.size() < 3) && samples.size() < 100000) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto stop = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        samples.push_back(ns);
+        total += ns;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()))];
+    };
+    return Result{name, samples.size(), bytes, samples.front(), total / samples.size(),
+                  percentile(0.5), percentile(0.9), percentile(0.99)};
+}
+
+/**
+ * @brief Генерирует текст в UTF-8 заданного размера в байтах из символов `letters`.
+ *
+ * @details Все символы одного алфавита имеют одинаковую длину в UTF-8; для смешанного
+ * текста размер добирается латинскими буквами.
+ */
+std::string randomUtf8(const std::vector<std::string>& letters, size_t bytes, std::mt19937& gen) {
+    std::string text;
+    text.reserve(bytes + 2);
+    while (text.size() < bytes) {
+        const std::string& letter = letters[gen() % letters.size()];
+        text += text.size() + letter.size() <= bytes ? letter : std::string("A");
+    }
+    return text;
+}
+
+/**
+ * @brief Буквы алфавита в UTF-8 по одной строке на букву.
+ */
+std::vector<std::string> utf8Letters(const std::string& alphabet) {
+    std::vector<std::string> letters;
+    for (size_t i = 0; i < alphabet.size();) {
+        const size_t length = (static_cast<unsigned char>(alphabet[i]) & 0x80) ? 2 : 1;
+        letters.push_back(alphabet.substr(i, length));
+        i += length;
+    }
+    return letters;
+}
+
+/**
+ * @brief Выводит строку JSON с экранированием кавычек и обратной косой черты.
+ */
+std::string quoted(const std::string& s) {
+    std::string result = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
+
+/**
+ * @brief Печатает результаты в формате JSON Google Benchmark.
+ */
+void printJson(const std::vector<Result>& results) {
+    char date[64];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+    char host[256] = "";
+    gethostname(host, sizeof(host) - 1);
+
+    std::printf("{\n  \"context\": {\n");
+    std::printf("    \"date\": %s,\n", quoted(date).c_str());
+    std::printf("    \"host_name\": %s,\n", quoted(host).c_str());
+    std::printf("    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    std::printf("    \"shift_kernel\": %s,\n", quoted(shiftKernelName(detectShiftKernel())).c_str());
+#ifdef NDEBUG
+    std::printf("    \"library_build_type\": \"release\"\n");
+#else
+    std::printf("    \"library_build_type\": \"debug\"\n");
+#endif
+    std::printf("  },\n  \"benchmarks\": [");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::printf("%s\n    {\n", i == 0 ? "" : ",");
+        std::printf("      \"name\": %s,\n", quoted(r.name).c_str());
+        std::printf("      \"run_type\": \"iteration\",\n");
+        std::printf("      \"iterations\": %zu,\n", r.iterations);
+        std::printf("      \"real_time\": %.1f,\n", r.p50Ns);
+        std::printf("      \"time_unit\": \"ns\",\n");
+        std::printf("      \"bytes\": %zu,\n", r.bytes);
+        std::printf("      \"bytes_per_second\": %.1f,\n", r.bytes / r.p50Ns * 1e9);
+        std::printf("      \"min_ns\": %.1f,\n", r.minNs);
+        std::printf("      \"mean_ns\": %.1f,\n", r.meanNs);
+        std::printf("      \"p50_ns\": %.1f,\n", r.p50Ns);
+        std::printf("      \"p90_ns\": %.1f,\n", r.p90Ns);
+        std::printf("      \"p99_ns\": %.1f\n", r.p99Ns);
+        std::printf("    }");
+    }
+    std::printf("\n  ]\n}\n");
+}
+
+/**
+ * @brief Разбирает параметры командной строки.
+ */
+Options parseOptions(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--filter=", 0) == 0) {
+            options.filter = arg.substr(9);
+        } else if (arg.rfind("--max-size=", 0) == 0) {
+            options.maxSize = std::stoull(arg.substr(11));
+        } else if (arg.rfind("--min-time=", 0) == 0) {
+            options.minTime = std::stod(arg.substr(11));
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\nusage: %s [--filter=STR] [--max-size=BYTES] [--min-time=SEC]\n", e.what(), argv[0]);
+        return 1;
+    }
+
+    const std::string russian = "АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    const std::string latin = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    const std::vector<std::pair<std::string, std::vector<std::string>>> alphabets = {
+        {"cyrillic", utf8Letters(russian)},
+        {"latin", utf8Letters(latin)},
+        {"mixed", utf8Letters(russian + latin)},
+    };
+    const std::vector<size_t> keyLengths = {1, 16, 256, 4096};
+
+    std::vector<Result> results;
+    std::mt19937 gen(42);
+    auto selected = [&options](const std::string& name) {
+        return name.find(options.filter) != std::string::npos;
+    };
+    auto run = [&](const std::string& name, size_t bytes, const std::function<void()>& call) {
+        if (selected(name)) {
+            std::fprintf(stderr, "%s\n", name.c_str());
+            results.push_back(measure(name, bytes, options.minTime, call));
+        }
+    };
+
+    for (size_t size = 16; size <= options.maxSize; size *= 16) {
+        for (const auto& alphabet : alphabets) {
+            const std::string suffix = "/" + alphabet.first + "/size:" + std::to_string(size) + "/key:";
+            const std::string text = randomUtf8(alphabet.second, size, gen);
+            std::string out(2 * text.size(), '\0');
+            std::string back(2 * text.size(), '\0');
+
+            for (size_t keyLength : keyLengths) {
+                const std::string tail = suffix + std::to_string(keyLength);
+                if (alphabet.first == "cyrillic" && (selected("modAlphaCipher/encrypt" + tail)
+                                                     || selected("modAlphaCipher/decrypt" + tail))) {
+                    std::string key;
+                    for (size_t i = 0; i < keyLength; i++) {
+                        key += alphabet.second[gen() % alphabet.second.size()];
+                    }
+                    std::wstring wideKey;
+                    for (size_t i = 0; i < key.size(); i += 2) {
+                        wideKey += static_cast<wchar_t>(((key[i] & 0x1F) << 6) | (key[i + 1] & 0x3F));
+                    }
+                    const modAlphaCipher cipher(wideKey);
+                    cipher.encrypt(text.data(), text.size(), &out[0]);
+                    run("modAlphaCipher/encrypt" + tail, size, [&] {
+                        cipher.encrypt(text.data(), text.size(), &back[0]);
+                        sink = back[0];
+                    });
+                    run("modAlphaCipher/decrypt" + tail, size, [&] {
+                        cipher.decrypt(out.data(), text.size(), &back[0]);
+                        sink = back[0];
+                    });
+                }
+
+                if (selected("modPermutationCipher/encrypt" + tail) || selected("modPermutationCipher/decrypt" + tail)) {
+                    std::wstring key;
+                    for (size_t i = 0; i < keyLength; i++) {
+                        key += static_cast<wchar_t>(L'1' + gen() % 9);
+                    }
+                    const modPermutationCipher cipher(key);
+                    size_t phase = 0;
+                    const size_t written = cipher.encrypt(text.data(), text.size(), &out[0], phase);
+                    run("modPermutationCipher/encrypt" + tail, size, [&] {
+                        size_t p = 0;
+                        cipher.encrypt(text.data(), text.size(), &back[0], p);
+                        sink = back[0];
+                    });
+                    run("modPermutationCipher/decrypt" + tail, size, [&] {
+                        size_t p = 0;
+                        cipher.decrypt(out.data(), written, &back[0], p);
+                        sink = back[0];
+                    });
+                }
+            }
+        }
+
+        // Маршрутная перестановка не зависит от алфавита: текст хранится в wchar_t,
+        // ключ — число столбцов таблицы.
+        const size_t length = size / sizeof(wchar_t);
+        if (selected("modAlphakey/") && length > 0) {
+            std::wstring text(length, L'А');
+            for (auto& c : text) {
+                c = static_cast<wchar_t>(L'А' + gen() % 32);
+            }
+            std::wstring out(length, L'\0');
+            std::wstring back(length, L'\0');
+            for (size_t keyLength : keyLengths) {
+                const std::string tail = "/wide/size:" + std::to_string(size) + "/key:" + std::to_string(keyLength);
+                modAlphakey cipher(static_cast<int>(keyLength));
+                cipher.encrypt(text.data(), length, &out[0]);
+                run("modAlphakey/encrypt" + tail, size, [&] {
+                    cipher.encrypt(text.data(), length, &back[0]);
+                    sink = static_cast<char>(back[0]);
+                });
+                run("modAlphakey/decrypt" + tail, size, [&] {
+                    cipher.decrypt(out.data(), length, &back[0]);
+                    sink = static_cast<char>(back[0]);
+                });
+            }
+        }
+    }
+
+    // Масштабирование: один общий объект шифра, у каждого потока свой буфер.
+    const std::vector<unsigned> threadCounts = {1, 2, 4, 8, 16, 32, 64};
+    auto runShared = [&](const std::string& cls, const std::function<void(unsigned)>& work) {
+        for (unsigned threads : threadCounts) {
+            run(cls + "/shared/threads:" + std::to_string(threads), threads * sharedWork, [&] {
+                std::vector<std::thread> workers;
+                workers.reserve(threads);
+                for (unsigned t = 0; t < threads; t++) {
+                    workers.emplace_back(work, t);
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+            });
+        }
+    };
+    const unsigned maxThreads = threadCounts.back();
+    if (selected("/shared/")) {
+        const std::string text = randomUtf8(alphabets[0].second, sharedWork, gen);
+        std::vector<std::string> outs(maxThreads, std::string(2 * text.size(), '\0'));
+        const std::wstring wideText(sharedWork / sizeof(wchar_t), L'Ж');
+        std::vector<std::wstring> wideOuts(maxThreads, std::wstring(wideText.size(), L'\0'));
+
+        const modAlphaCipher gronsfeld(L"ШИФРОВАНИЕ");
+        runShared("modAlphaCipher", [&](unsigned t) {
+            gronsfeld.encrypt(text.data(), text.size(), &outs[t][0]);
+        });
+        const modPermutationCipher permutation(L"31415926");
+        runShared("modPermutationCipher", [&](unsigned t) {
+            size_t phase = 0;
+            permutation.encrypt(text.data(), text.size(), &outs[t][0], phase);
+        });
+        const modAlphakey route(16);
+        runShared("modAlphakey", [&](unsigned t) {
+            route.encrypt(wideText.data(), wideText.size(), &wideOuts[t][0]);
+        });
+        sink = outs[0][0];
+    }
+
+    printJson(results);
+    return 0;
+}
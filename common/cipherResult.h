@@ -0,0 +1,36 @@
+/**
+ * @file cipherResult.h
+ * @brief Код результата для методов шифрования, не выбрасывающих исключений.
+ *
+ * @details
+ * Общий для шифров laba4_chast1 и laba4_chast2.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <cstddef>
+
+/**
+ * @brief Код результата преобразования без исключений.
+ */
+enum class CipherStatus {
+    ok,                 /**< Текст обработан. */
+    invalidCharacter,   /**< Символ не входит в алфавит или UTF-8 обрывается посреди символа. */
+    unsupportedAlphabet /**< Интерфейс не поддерживает алфавит шифра (буквы разной длины в UTF-8). */
+};
+
+/**
+ * @brief Результат `tryEncrypt`/`tryDecrypt`.
+ */
+struct CipherResult {
+    CipherStatus status; /**< Код результата. */
+    size_t offset;       /**< При ошибке — позиция первого недопустимого символа (байта для UTF-8), иначе длина текста. */
+    size_t phase;        /**< При успехе — позиция ключа для символа, следующего за последним. */
+
+    /**
+     * @brief true, если текст обработан.
+     */
+    explicit operator bool() const noexcept { return status == CipherStatus::ok; }
+};
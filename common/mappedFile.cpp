@@ -0,0 +1,146 @@
+/**
+ * @file mappedFile.cpp
+ * @brief Реализация отображения файлов в память через POSIX mmap.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "mappedFile.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::runtime_error systemError(const std::string& what, const std::string& path) {
+    return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw systemError("Cannot open", path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        release();
+        throw systemError("Cannot stat", path);
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0) {
+        return;
+    }
+    void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) {
+        release();
+        throw systemError("Cannot map", path);
+    }
+    bytes = static_cast<char*>(address);
+    ::madvise(address, length, MADV_SEQUENTIAL);
+}
+
+MappedFile::MappedFile(const std::string& path, size_t size) {
+    // Символическая ссылка заменяется не сама, а файл, на который она указывает.
+    char* resolved = ::realpath(path.c_str(), nullptr);
+    target = resolved != nullptr ? resolved : path;
+    std::free(resolved);
+    struct stat st;
+    const mode_t mode = ::stat(target.c_str(), &st) == 0 ? st.st_mode & 07777 : 0644;
+
+    // Временный файл в том же каталоге, чтобы rename в commit() не пересекал файловые системы.
+    std::string pattern = target + ".XXXXXX";
+    fd = ::mkstemp(&pattern[0]);
+    if (fd < 0) {
+        throw systemError("Cannot create", pattern);
+    }
+    temporary = pattern;
+    if (::fchmod(fd, mode) != 0 || ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        const std::runtime_error error = systemError("Cannot resize", temporary);
+        discard();
+        throw error;
+    }
+    length = size;
+    if (length == 0) {
+        return;
+    }
+    void* address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        const std::runtime_error error = systemError("Cannot map", temporary);
+        discard();
+        throw error;
+    }
+    bytes = static_cast<char*>(address);
+}
+
+MappedFile::~MappedFile() {
+    discard();
+}
+
+void MappedFile::release() {
+    if (bytes != nullptr) {
+        ::munmap(bytes, length);
+        bytes = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void MappedFile::discard() {
+    release();
+    if (!temporary.empty()) {
+        ::unlink(temporary.c_str());
+        temporary.clear();
+    }
+}
+
+void MappedFile::truncate(size_t size) {
+    if (bytes != nullptr) {
+        ::munmap(bytes, length);
+        bytes = nullptr;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        throw std::runtime_error(std::string("Cannot resize output: ") + std::strerror(errno));
+    }
+    length = size;
+}
+
+void MappedFile::commit() {
+    // Данные сбрасываются на диск до rename: иначе после сбоя питания выходной файл
+    // (при шифровании на месте — и исходный) может оказаться пустым или обрезанным,
+    // а ошибки отложенной записи (ENOSPC, EIO) не были бы замечены.
+    if (::fsync(fd) != 0) {
+        const std::runtime_error error = systemError("Cannot write", temporary);
+        discard();
+        throw error;
+    }
+    release();
+    if (::rename(temporary.c_str(), target.c_str()) != 0) {
+        throw systemError("Cannot replace", target);
+    }
+    temporary.clear();
+
+    // Сама замена — запись в каталоге, её тоже нужно сбросить на диск.
+    const std::string::size_type slash = target.rfind('/');
+    const std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : target.substr(0, slash);
+    const int dir = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dir < 0) {
+        throw systemError("Cannot open", directory);
+    }
+    // EINVAL: файловая система не поддерживает fsync каталога, замена уже выполнена.
+    if (::fsync(dir) != 0 && errno != EINVAL) {
+        const std::runtime_error error = systemError("Cannot sync", directory);
+        ::close(dir);
+        throw error;
+    }
+    ::close(dir);
+}
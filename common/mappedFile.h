@@ -0,0 +1,97 @@
+/**
+ * @file mappedFile.h
+ * @brief Отображение файла в память (mmap) для пакетного шифрования без копирования.
+ *
+ * @details
+ * Входной файл отображается только для чтения, выходной создаётся заданного
+ * размера и отображается для записи. Результат пишется во временный файл в том же
+ * каталоге и заменяет выходной только в commit(), поэтому выходной файл может
+ * совпадать с входным, а при ошибке остаётся нетронутым. Ошибки системных вызовов
+ * выбрасываются в виде исключений `std::runtime_error`.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * @class MappedFile
+ * @brief Файл, отображённый в память.
+ *
+ * @details Отображение и дескриптор освобождаются в деструкторе; там же удаляется
+ * временный файл, если результат не был сохранён через commit().
+ */
+class MappedFile {
+private:
+    int fd = -1;            /**< Дескриптор файла. */
+    char* bytes = nullptr;  /**< Начало отображения (nullptr для пустого файла). */
+    size_t length = 0;      /**< Размер отображения в байтах. */
+    std::string target;     /**< Выходной файл, который заменит commit(). */
+    std::string temporary;  /**< Временный файл с результатом (пусто, если его нет). */
+
+    /**
+     * @brief Снимает отображение и закрывает файл.
+     */
+    void release();
+
+    /**
+     * @brief Снимает отображение и удаляет несохранённый временный файл.
+     */
+    void discard();
+
+public:
+    MappedFile() = delete; /**< Конструктор по умолчанию запрещен. */
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Отображает существующий файл только для чтения.
+     *
+     * @param path Путь к файлу.
+     * @throws std::runtime_error Если файл не удалось открыть или отобразить.
+     */
+    explicit MappedFile(const std::string& path);
+
+    /**
+     * @brief Создаёт временный файл заданного размера рядом с `path` и отображает его для записи.
+     *
+     * @details Файл `path` не открывается и не изменяется до вызова commit().
+     *
+     * @param path Путь к выходному файлу.
+     * @param size Размер файла в байтах.
+     * @throws std::runtime_error Если файл не удалось создать или отобразить.
+     */
+    MappedFile(const std::string& path, size_t size);
+
+    ~MappedFile();
+
+    const char* data() const { return bytes; } /**< Начало данных. */
+    char* data() { return bytes; }             /**< Начало данных для записи. */
+    size_t size() const { return length; }     /**< Размер в байтах. */
+
+    /**
+     * @brief Снимает отображение и обрезает файл до заданного размера.
+     *
+     * @details Нужна, когда точный размер результата становится известен только
+     * после обработки. После вызова данные недоступны.
+     *
+     * @param size Итоговый размер файла (не больше текущего).
+     * @throws std::runtime_error Если файл не удалось обрезать.
+     */
+    void truncate(size_t size);
+
+    /**
+     * @brief Сбрасывает файл на диск, снимает отображение и заменяет им выходной (rename).
+     *
+     * @details Временный файл, а после замены и каталог сбрасываются на диск (fsync),
+     * поэтому после сбоя остаётся либо прежний выходной файл, либо новый целиком.
+     * Права существующего выходного файла сохраняются. После вызова данные недоступны.
+     *
+     * @throws std::runtime_error Если файл не удалось записать на диск или переименовать;
+     * при ошибке записи выходной файл не изменяется.
+     */
+    void commit();
+};
@@ -0,0 +1,306 @@
+/**
+ * @file metrics.h
+ * @brief Счётчики горячего пути шифрования, включаемые при сборке.
+ *
+ * @details
+ * При сборке с `-DCIPHER_METRICS` (`make METRICS=1`) шифр считает вызовы, обработанные
+ * байты, отказы из-за недопустимых символов, выделения памяти под результат и такты
+ * процессора по фазам: проверка, преобразование "символ ↔ номер", сдвиг и выделение
+ * памяти. Без флага макросы METRIC_COUNT и METRIC_PHASE пусты, а METRIC_TIME
+ * сводится к самому выражению, так что выключенные счётчики ничего не стоят.
+ *
+ * Каждый поток пишет в свой блок счётчиков (атомарные загрузка и запись без блокировок
+ * и без RMW-инструкций: у блока один писатель). Завершаясь, поток прибавляет свои
+ * значения к общему итогу завершившихся потоков, обнуляет блок и кладёт его в список
+ * свободных: следующий поток возьмёт его вместо нового, поэтому блоков не больше, чем
+ * потоков, считавших одновременно. collectMetrics() суммирует итог и все блоки.
+ * Список блоков меняется под мьютексом — только при первом обращении потока
+ * и при его завершении, горячий путь мьютекс не берёт.
+ *
+ * Снимок выводится в текстовом формате Prometheus или в JSON (formatMetrics()).
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Счётчики событий.
+ */
+enum class MetricCounter : unsigned {
+    calls,       /**< Вызовы ядра шифрования (части параллельной обработки считаются отдельно). */
+    bytes,       /**< Обработанные байты входа (для wchar_t — `length * sizeof(wchar_t)`). */
+    rejections,  /**< Отказы из-за недопустимых символов. */
+    allocations, /**< Выделения памяти под результат. */
+    count
+};
+
+/**
+ * @brief Фазы, по которым считаются такты.
+ */
+enum class MetricPhase : unsigned {
+    validate, /**< Проверка символов. */
+    convert,  /**< Перевод символов в номера и обратно (в UTF-8 — вместе с разбором байт). */
+    shift,    /**< Сдвиг номеров. */
+    allocate, /**< Выделение памяти под результат. */
+    count
+};
+
+constexpr size_t metricCounterCount = static_cast<size_t>(MetricCounter::count); /**< Число счётчиков. */
+constexpr size_t metricPhaseCount = static_cast<size_t>(MetricPhase::count);     /**< Число фаз. */
+
+/**
+ * @brief Формат вывода снимка.
+ */
+enum class MetricsFormat {
+    prometheus, /**< Текстовый формат Prometheus. */
+    json        /**< Объект JSON. */
+};
+
+/**
+ * @brief Сумма счётчиков всех потоков.
+ */
+struct MetricsSnapshot {
+    bool enabled = false; /**< Собрана ли программа с CIPHER_METRICS. */
+    std::array<std::uint64_t, metricCounterCount> counters{}; /**< Значения MetricCounter. */
+    std::array<std::uint64_t, metricPhaseCount> phaseCalls{}; /**< Число замеров каждой фазы. */
+    std::array<std::uint64_t, metricPhaseCount> phaseCycles{}; /**< Такты каждой фазы. */
+
+    /**
+     * @brief Значение счётчика.
+     */
+    std::uint64_t operator[](MetricCounter counter) const { return counters[static_cast<size_t>(counter)]; }
+};
+
+/**
+ * @brief Счётчики одного потока.
+ */
+struct ThreadMetrics {
+    std::array<std::atomic<std::uint64_t>, metricCounterCount> counters{};
+    std::array<std::atomic<std::uint64_t>, metricPhaseCount> phaseCalls{};
+    std::array<std::atomic<std::uint64_t>, metricPhaseCount> phaseCycles{};
+    ThreadMetrics* next = nullptr;     /**< Следующий блок в списке всех блоков. */
+    ThreadMetrics* nextFree = nullptr; /**< Следующий блок в списке свободных. */
+};
+
+/**
+ * @brief Все блоки счётчиков и итог завершившихся потоков.
+ */
+struct MetricsRegistry {
+    std::mutex mutex;                 /**< Защищает списки и итог. */
+    ThreadMetrics* blocks = nullptr;  /**< Все блоки: занятые и свободные. */
+    ThreadMetrics* free = nullptr;    /**< Свободные блоки (обнулены). */
+    MetricsSnapshot retired;          /**< Сумма счётчиков завершившихся потоков. */
+};
+
+/**
+ * @brief Реестр блоков всех потоков.
+ */
+inline MetricsRegistry metricsRegistry;
+
+/**
+ * @brief Владелец блока текущего потока: берёт блок при создании и возвращает при завершении потока.
+ */
+class ThreadMetricsOwner {
+private:
+    ThreadMetrics* block; /**< Блок потока. */
+
+public:
+    ThreadMetricsOwner() {
+        std::lock_guard<std::mutex> lock(metricsRegistry.mutex);
+        block = metricsRegistry.free;
+        if (block != nullptr) {
+            metricsRegistry.free = block->nextFree;
+        } else {
+            block = new ThreadMetrics();
+            block->next = metricsRegistry.blocks;
+            metricsRegistry.blocks = block;
+        }
+    }
+
+    /**
+     * @brief Переносит значения блока в итог завершившихся потоков и освобождает блок.
+     */
+    ~ThreadMetricsOwner() {
+        std::lock_guard<std::mutex> lock(metricsRegistry.mutex);
+        MetricsSnapshot& retired = metricsRegistry.retired;
+        for (size_t i = 0; i < metricCounterCount; i++) {
+            retired.counters[i] += block->counters[i].exchange(0, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < metricPhaseCount; i++) {
+            retired.phaseCalls[i] += block->phaseCalls[i].exchange(0, std::memory_order_relaxed);
+            retired.phaseCycles[i] += block->phaseCycles[i].exchange(0, std::memory_order_relaxed);
+        }
+        block->nextFree = metricsRegistry.free;
+        metricsRegistry.free = block;
+    }
+
+    ThreadMetricsOwner(const ThreadMetricsOwner&) = delete;
+    ThreadMetricsOwner& operator=(const ThreadMetricsOwner&) = delete;
+
+    ThreadMetrics& get() const { return *block; }
+};
+
+/**
+ * @brief Блок текущего потока; при первом обращении берётся из свободных или создаётся.
+ */
+inline ThreadMetrics& threadMetrics() {
+    thread_local ThreadMetricsOwner owner;
+    return owner.get();
+}
+
+/**
+ * @brief Прибавляет значение к счётчику своего потока (писатель у счётчика один).
+ */
+inline void metricAdd(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Текущее значение счётчика тактов (TSC на x86, иначе наносекунды).
+ */
+inline std::uint64_t metricClock() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * @brief Замер фазы: такты от создания до конца области видимости.
+ */
+class MetricScope {
+private:
+    MetricPhase phase;
+    std::uint64_t start;
+
+public:
+    explicit MetricScope(MetricPhase phase) : phase(phase), start(metricClock()) {}
+
+    ~MetricScope() {
+        ThreadMetrics& metrics = threadMetrics();
+        const size_t i = static_cast<size_t>(phase);
+        metricAdd(metrics.phaseCycles[i], metricClock() - start);
+        metricAdd(metrics.phaseCalls[i], 1);
+    }
+
+    MetricScope(const MetricScope&) = delete;
+    MetricScope& operator=(const MetricScope&) = delete;
+};
+
+/**
+ * @brief Вычисляет `f()` и относит затраченные такты к фазе.
+ */
+template <class F>
+auto metricTime(MetricPhase phase, const F& f) -> decltype(f()) {
+    MetricScope scope(phase);
+    return f();
+}
+
+#ifdef CIPHER_METRICS
+#define METRIC_CONCAT_(a, b) a##b
+#define METRIC_CONCAT(a, b) METRIC_CONCAT_(a, b)
+/** Прибавляет `value` к счётчику MetricCounter::name. */
+#define METRIC_COUNT(name, value) \
+    metricAdd(threadMetrics().counters[static_cast<size_t>(MetricCounter::name)], (value))
+/** Замеряет такты фазы MetricPhase::name до конца области видимости. */
+#define METRIC_PHASE(name) MetricScope METRIC_CONCAT(metricScope, __LINE__)(MetricPhase::name)
+/** Вычисляет выражение и относит затраченные такты к фазе MetricPhase::name. */
+#define METRIC_TIME(name, ...) metricTime(MetricPhase::name, [&] { return __VA_ARGS__; })
+#else
+#define METRIC_COUNT(name, value) ((void)0)
+#define METRIC_PHASE(name) ((void)0)
+#define METRIC_TIME(name, ...) (__VA_ARGS__)
+#endif
+
+/**
+ * @brief Собирает сумму счётчиков всех потоков, в том числе завершившихся.
+ *
+ * @details Не останавливает потоки: значения, записываемые во время сбора,
+ * могут войти в снимок частично. Завершение потока во время сбора ждёт его конца,
+ * поэтому значения потока не теряются и не учитываются дважды.
+ */
+inline MetricsSnapshot collectMetrics() {
+    MetricsSnapshot snapshot;
+#ifdef CIPHER_METRICS
+    snapshot.enabled = true;
+#endif
+    std::lock_guard<std::mutex> lock(metricsRegistry.mutex);
+    const MetricsSnapshot& retired = metricsRegistry.retired;
+    snapshot.counters = retired.counters;
+    snapshot.phaseCalls = retired.phaseCalls;
+    snapshot.phaseCycles = retired.phaseCycles;
+    for (ThreadMetrics* block = metricsRegistry.blocks; block != nullptr; block = block->next) {
+        for (size_t i = 0; i < metricCounterCount; i++) {
+            snapshot.counters[i] += block->counters[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < metricPhaseCount; i++) {
+            snapshot.phaseCalls[i] += block->phaseCalls[i].load(std::memory_order_relaxed);
+            snapshot.phaseCycles[i] += block->phaseCycles[i].load(std::memory_order_relaxed);
+        }
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Выводит снимок в заданном формате.
+ *
+ * @param snapshot Снимок (см. collectMetrics()).
+ * @param format Текст Prometheus или JSON.
+ * @return std::string Текст снимка.
+ */
+inline std::string formatMetrics(const MetricsSnapshot& snapshot, MetricsFormat format) {
+    static const char* const counterNames[metricCounterCount] = {"calls", "bytes", "rejections", "allocations"};
+    static const char* const phaseNames[metricPhaseCount] = {"validate", "convert", "shift", "allocate"};
+    std::string text;
+    char line[160];
+    auto append = [&](int length) { text.append(line, static_cast<size_t>(length)); };
+    if (format == MetricsFormat::prometheus) {
+        append(std::snprintf(line, sizeof(line), "# TYPE cipher_metrics_enabled gauge\ncipher_metrics_enabled %d\n",
+                             snapshot.enabled ? 1 : 0));
+        for (size_t i = 0; i < metricCounterCount; i++) {
+            append(std::snprintf(line, sizeof(line), "# TYPE cipher_%s_total counter\ncipher_%s_total %llu\n",
+                                 counterNames[i], counterNames[i],
+                                 static_cast<unsigned long long>(snapshot.counters[i])));
+        }
+        text += "# TYPE cipher_phase_calls_total counter\n";
+        for (size_t i = 0; i < metricPhaseCount; i++) {
+            append(std::snprintf(line, sizeof(line), "cipher_phase_calls_total{phase=\"%s\"} %llu\n",
+                                 phaseNames[i], static_cast<unsigned long long>(snapshot.phaseCalls[i])));
+        }
+        text += "# TYPE cipher_phase_cycles_total counter\n";
+        for (size_t i = 0; i < metricPhaseCount; i++) {
+            append(std::snprintf(line, sizeof(line), "cipher_phase_cycles_total{phase=\"%s\"} %llu\n",
+                                 phaseNames[i], static_cast<unsigned long long>(snapshot.phaseCycles[i])));
+        }
+        return text;
+    }
+    append(std::snprintf(line, sizeof(line), "{\"enabled\": %s", snapshot.enabled ? "true" : "false"));
+    for (size_t i = 0; i < metricCounterCount; i++) {
+        append(std::snprintf(line, sizeof(line), ", \"%s\": %llu", counterNames[i],
+                             static_cast<unsigned long long>(snapshot.counters[i])));
+    }
+    text += ", \"phases\": {";
+    for (size_t i = 0; i < metricPhaseCount; i++) {
+        append(std::snprintf(line, sizeof(line), "%s\"%s\": {\"calls\": %llu, \"cycles\": %llu}", i ? ", " : "",
+                             phaseNames[i], static_cast<unsigned long long>(snapshot.phaseCalls[i]),
+                             static_cast<unsigned long long>(snapshot.phaseCycles[i])));
+    }
+    text += "}}\n";
+    return text;
+}
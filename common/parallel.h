@@ -0,0 +1,247 @@
+/**
+ * @file parallel.h
+ * @brief Запуск одной задачи на нескольких потоках для пакетного шифрования.
+ *
+ * @details
+ * Шифры зависят от позиции символа только через позицию ключа, поэтому большой
+ * текст делится на части, и каждая часть обрабатывается своим потоком
+ * с заранее вычисленной позицией ключа.
+ *
+ * Для шифрования текст делится на блоки по `parallelBlock` байт, которые потоки
+ * разбирают по возрастанию номеров (runBlocks()). Позиция ключа и смещение
+ * результата передаются от блока к следующему через BlockChain: блок сначала
+ * считает свои буквы, затем ждёт значение предыдущего блока, публикует своё
+ * и шифрует. Блок помещается в кэш, поэтому текст читается из памяти один раз.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Минимальный размер части (байт), ради которого имеет смысл заводить отдельный поток.
+ */
+constexpr size_t minParallelPart = 1 << 16;
+
+/**
+ * @brief Выбирает число потоков для текста заданной длины.
+ *
+ * @param threads Запрошенное число потоков (0 — по числу ядер).
+ * @param length Длина текста в байтах.
+ * @return unsigned Число потоков, не меньше 1.
+ */
+inline unsigned parallelThreads(unsigned threads, size_t length) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t parts = std::max<size_t>(1, length / minParallelPart);
+    return static_cast<unsigned>(std::min<size_t>(threads, parts));
+}
+
+/**
+ * @brief Выполняет `task(part)` для `part = 0 .. threads - 1`, каждую часть в своём потоке.
+ *
+ * @details Часть 0 выполняется в вызывающем потоке. Если какая-либо часть выбросила
+ * исключение, после завершения всех потоков оно выбрасывается повторно.
+ *
+ * @param threads Число частей.
+ * @param task Функция, принимающая номер части.
+ */
+template <class Task>
+void runParallel(unsigned threads, const Task& task) {
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned part = 1; part < threads; part++) {
+        workers.emplace_back([&task, &errors, part] {
+            try {
+                task(part);
+            } catch (...) {
+                errors[part] = std::current_exception();
+            }
+        });
+    }
+    try {
+        task(0);
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * @brief Ближайшая к `pos` граница символа UTF-8 справа (не дальше конца текста).
+ *
+ * @param text Байты UTF-8.
+ * @param length Количество байт.
+ * @param pos Смещение.
+ * @return size_t Смещение первого байта символа или `length`.
+ */
+inline size_t utf8Boundary(const char* text, size_t length, size_t pos) {
+    pos = std::min(pos, length);
+    while (pos < length && (static_cast<unsigned char>(text[pos]) & 0xC0) == 0x80) {
+        pos++;
+    }
+    return pos;
+}
+
+/**
+ * @brief Делит текст в UTF-8 на части, не разрывая многобайтовые символы.
+ *
+ * @param text Байты UTF-8.
+ * @param length Количество байт.
+ * @param threads Число частей.
+ * @return std::vector<size_t> Границы частей: `threads + 1` смещений от 0 до `length`.
+ */
+inline std::vector<size_t> splitUtf8(const char* text, size_t length, unsigned threads) {
+    std::vector<size_t> bounds(threads + 1, length);
+    bounds[0] = 0;
+    for (unsigned part = 1; part < threads; part++) {
+        bounds[part] = utf8Boundary(text, length, std::max(bounds[part - 1], length / threads * part));
+    }
+    return bounds;
+}
+
+/**
+ * @brief Размер блока (байт) для runBlocks(): блок вместе с результатом помещается в кэш L2.
+ */
+constexpr size_t parallelBlock = 1 << 16;
+
+/**
+ * @class BlockChain
+ * @brief Значения, передаваемые от блока к следующему: префиксная сумма по блокам.
+ *
+ * @details Блок `b` получает через wait() значение, опубликованное блоком `b - 1`
+ * (для блока 0 — начальное), и публикует своё через publish(). Блоки раздаются
+ * по возрастанию номеров, поэтому предыдущий блок уже обрабатывается и ожидание коротко.
+ */
+class BlockChain {
+private:
+    /**
+     * @brief Значение после блока и признак того, что оно опубликовано.
+     */
+    struct Slot {
+        std::atomic<bool> ready{false};
+        size_t value = 0;
+    };
+
+    std::unique_ptr<Slot[]> slots;                         /**< `blocks + 1` значений, нулевое — начальное. */
+    std::atomic<size_t> broken{static_cast<size_t>(-1)};  /**< Первый блок, завершившийся ошибкой. */
+
+public:
+    /**
+     * @brief Ожидание прервано: один из предыдущих блоков завершился ошибкой.
+     */
+    struct Broken {};
+
+    /**
+     * @param blocks Число блоков.
+     * @param initial Значение перед блоком 0.
+     */
+    BlockChain(size_t blocks, size_t initial) : slots(new Slot[blocks + 1]) {
+        slots[0].value = initial;
+        slots[0].ready.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Ждёт значение перед блоком `block` (после всех предыдущих блоков).
+     *
+     * @throws Broken Если значение не появится, потому что предыдущий блок завершился ошибкой.
+     */
+    size_t wait(size_t block) const {
+        while (!slots[block].ready.load(std::memory_order_acquire)) {
+            if (broken.load(std::memory_order_acquire) < block) {
+                throw Broken{};
+            }
+            std::this_thread::yield();
+        }
+        return slots[block].value;
+    }
+
+    /**
+     * @brief Публикует значение после блока `block`.
+     */
+    void publish(size_t block, size_t value) {
+        slots[block + 1].value = value;
+        slots[block + 1].ready.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Отмечает, что блок `block` завершился ошибкой: следующие блоки перестают ждать.
+     */
+    void breakAt(size_t block) {
+        size_t current = broken.load(std::memory_order_relaxed);
+        while (block < current && !broken.compare_exchange_weak(current, block, std::memory_order_release)) {
+        }
+    }
+};
+
+/**
+ * @brief Выполняет `task(block)` для `block = 0 .. blocks - 1` на `threads` потоках.
+ *
+ * @details Потоки берут блоки по возрастанию номеров. Если блок выбросил исключение,
+ * цепочки `chains` прерываются после него, новые блоки за ним не берутся, а после
+ * завершения всех потоков выбрасывается исключение блока с наименьшим номером —
+ * то же, что дала бы последовательная обработка.
+ *
+ * @param threads Число потоков.
+ * @param blocks Число блоков.
+ * @param task Функция, принимающая номер блока.
+ * @param chains Цепочки, через которые блоки передают значения друг другу.
+ */
+template <class Task, class... Chains>
+void runBlocks(unsigned threads, size_t blocks, const Task& task, Chains&... chains) {
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> failed{blocks};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&] {
+        while (true) {
+            const size_t block = next.fetch_add(1, std::memory_order_relaxed);
+            if (block >= failed.load(std::memory_order_acquire)) {
+                return;
+            }
+            try {
+                task(block);
+            } catch (const BlockChain::Broken&) {
+                return;
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (block < failed.load(std::memory_order_relaxed)) {
+                    error = std::current_exception();
+                    failed.store(block, std::memory_order_release);
+                }
+                (chains.breakAt(block), ...);
+                return;
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (unsigned part = 1; part < threads; part++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
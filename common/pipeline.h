@@ -0,0 +1,272 @@
+/**
+ * @file pipeline.h
+ * @brief Конвейер "чтение → преобразование → запись" для потокового режима.
+ *
+ * @details
+ * Чтение и запись идут в своих потоках, преобразование — в вызывающем. Блоки ходят
+ * по кольцу из `pipelineDepth` буферов: пока один блок шифруется, следующий уже
+ * читается, а предыдущий записывается, поэтому шифрование не простаивает, пока
+ * диск успевает за ним, и скорость конвейера стремится к меньшей из скоростей
+ * диска и шифра. Каждая стадия считает время работы и время ожидания соседей.
+ *
+ * Блок заканчивается на границе символа UTF-8: неполная последовательность в конце
+ * прочитанного переносится в начало следующего блока.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include "utf8.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Число буферов в кольце: по одному на каждую стадию и один запасной.
+ */
+constexpr size_t pipelineDepth = 4;
+
+/**
+ * @brief Время одной стадии конвейера (секунды).
+ */
+struct StageTiming {
+    double busy = 0; /**< Время работы (чтение, шифрование или запись). */
+    double wait = 0; /**< Время ожидания блока от соседней стадии. */
+};
+
+/**
+ * @brief Итог работы конвейера.
+ */
+struct PipelineTiming {
+    StageTiming read;      /**< Стадия чтения. */
+    StageTiming transform; /**< Стадия преобразования. */
+    StageTiming write;     /**< Стадия записи. */
+    double total = 0;      /**< Время от начала до конца (секунды). */
+    size_t bytesIn = 0;    /**< Прочитано байт. */
+    size_t bytesOut = 0;   /**< Записано байт. */
+};
+
+/**
+ * @class BlockQueue
+ * @brief Очередь номеров блоков между двумя стадиями.
+ */
+class BlockQueue {
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<size_t> blocks;
+    bool closed = false;  /**< Новых блоков не будет. */
+    bool aborted = false; /**< Конвейер остановлен ошибкой. */
+
+public:
+    /**
+     * @brief Передаёт блок следующей стадии.
+     */
+    void push(size_t block) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            blocks.push_back(block);
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * @brief Забирает блок, ожидая его появления.
+     *
+     * @param block Номер блока.
+     * @param wait Сюда добавляется время ожидания.
+     * @return false Если блоков больше не будет или конвейер остановлен.
+     */
+    bool pop(size_t& block, double& wait) {
+        const auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [this] { return aborted || closed || !blocks.empty(); });
+        wait += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (aborted || blocks.empty()) {
+            return false;
+        }
+        block = blocks.front();
+        blocks.pop_front();
+        return true;
+    }
+
+    /**
+     * @brief Сообщает, что новых блоков не будет; оставшиеся ещё можно забрать.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+    /**
+     * @brief Останавливает конвейер: pop() сразу возвращает false.
+     */
+    void abort() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            aborted = true;
+        }
+        ready.notify_all();
+    }
+};
+
+/**
+ * @brief Читает, преобразует и записывает поток, совмещая стадии во времени.
+ *
+ * @details Вызов `transform(in, length, out)` получает блоки по порядку и возвращает
+ * число записанных в `out` байт. Если какая-либо стадия выбросила исключение,
+ * остальные останавливаются (чтение — после текущего блока), и исключение
+ * выбрасывается повторно.
+ *
+ * @param in Входной поток.
+ * @param out Выходной поток.
+ * @param blockSize Размер блока чтения (байт).
+ * @param outputFactor Во сколько раз результат блока может быть длиннее входа.
+ * @param transform Функция `size_t(const char* in, size_t length, char* out)`.
+ * @param readError Текст исключения при ошибке чтения.
+ * @param writeError Текст исключения при ошибке записи.
+ * @return PipelineTiming Время стадий и объём данных.
+ */
+template <class Transform>
+PipelineTiming runPipeline(std::FILE* in, std::FILE* out, size_t blockSize, size_t outputFactor,
+                           const Transform& transform, const char* readError, const char* writeError) {
+    struct Block {
+        std::vector<char> input;
+        std::vector<char> output;
+        size_t length = 0;
+        size_t written = 0;
+    };
+    std::vector<Block> blocks(pipelineDepth);
+    for (Block& block : blocks) {
+        block.input.resize(blockSize + 3);
+        block.output.resize(outputFactor * (blockSize + 3));
+    }
+    BlockQueue free;
+    BlockQueue filled;
+    BlockQueue done;
+    for (size_t i = 0; i < pipelineDepth; i++) {
+        free.push(i);
+    }
+    PipelineTiming timing;
+    std::exception_ptr readFailure;
+    std::exception_ptr writeFailure;
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsed = [](std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+    };
+
+    std::thread reader([&] {
+        try {
+            char tail[3];
+            size_t tailLength = 0;
+            size_t index;
+            while (free.pop(index, timing.read.wait)) {
+                Block& block = blocks[index];
+                std::memcpy(block.input.data(), tail, tailLength);
+                const auto begin = std::chrono::steady_clock::now();
+                const size_t read = std::fread(block.input.data() + tailLength, 1, blockSize, in);
+                timing.read.busy += elapsed(begin);
+                if (read == 0 && std::ferror(in)) {
+                    throw std::runtime_error(readError);
+                }
+                timing.bytesIn += read;
+                block.length = tailLength + read;
+                // Неполный символ в конце ждёт следующего блока; в конце потока его отвергнет шифр.
+                tailLength = read == 0 ? 0 : utf8Tail(block.input.data(), block.length);
+                block.length -= tailLength;
+                std::memcpy(tail, block.input.data() + block.length, tailLength);
+                if (read == 0 && block.length == 0) {
+                    break;
+                }
+                if (block.length == 0) {
+                    free.push(index); // прочитан только первый байт символа
+                    continue;
+                }
+                filled.push(index);
+            }
+        } catch (...) {
+            readFailure = std::current_exception();
+            done.abort();
+            free.abort();
+        }
+        filled.close();
+    });
+
+    std::thread writer([&] {
+        try {
+            size_t index;
+            while (done.pop(index, timing.write.wait)) {
+                Block& block = blocks[index];
+                const auto begin = std::chrono::steady_clock::now();
+                if (std::fwrite(block.output.data(), 1, block.written, out) != block.written) {
+                    throw std::runtime_error(writeError);
+                }
+                timing.write.busy += elapsed(begin);
+                timing.bytesOut += block.written;
+                free.push(index);
+            }
+            const auto begin = std::chrono::steady_clock::now();
+            if (std::fflush(out) != 0) {
+                throw std::runtime_error(writeError);
+            }
+            timing.write.busy += elapsed(begin);
+        } catch (...) {
+            writeFailure = std::current_exception();
+            filled.abort();
+            free.abort();
+        }
+    });
+
+    std::exception_ptr transformFailure;
+    try {
+        size_t index;
+        while (filled.pop(index, timing.transform.wait)) {
+            Block& block = blocks[index];
+            const auto begin = std::chrono::steady_clock::now();
+            block.written = transform(block.input.data(), block.length, block.output.data());
+            timing.transform.busy += elapsed(begin);
+            done.push(index);
+        }
+        done.close();
+    } catch (...) {
+        transformFailure = std::current_exception();
+        free.abort();
+        done.abort();
+    }
+    reader.join();
+    writer.join();
+    for (const std::exception_ptr& failure : {transformFailure, readFailure, writeFailure}) {
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+    timing.total = elapsed(start);
+    return timing;
+}
+
+/**
+ * @brief Печатает время стадий конвейера, по строке на стадию.
+ */
+inline void printPipelineTiming(std::FILE* stream, const PipelineTiming& timing) {
+    auto speed = [](size_t bytes, double seconds) { return seconds > 0 ? bytes / seconds / 1e6 : 0.0; };
+    auto stage = [&](const char* name, const StageTiming& t, size_t bytes) {
+        std::fprintf(stream, "%s: работа %.3f с, ожидание %.3f с, %.1f МБ/с\n", name, t.busy, t.wait,
+                     speed(bytes, t.busy));
+    };
+    stage("чтение", timing.read, timing.bytesIn);
+    stage("шифрование", timing.transform, timing.bytesIn);
+    stage("запись", timing.write, timing.bytesOut);
+    std::fprintf(stream, "всего: %.3f с, %.1f МБ/с\n", timing.total, speed(timing.bytesIn, timing.total));
+}
@@ -0,0 +1,359 @@
+/**
+ * @file runtimeAlphabet.h
+ * @brief Алфавит шифра, заданный во время работы программы: строкой или файлом.
+ *
+ * Алфавит — упорядоченный набор до 256 различных символов Юникода. При создании
+ * он один раз строит плотные таблицы: номер буквы по коду и букву по номеру.
+ * Если коды букв укладываются в отрезок не длиннее denseLimit (любые буквы одного
+ * или соседних блоков Юникода, например кириллица с латиницей), таблица номеров
+ * одна — по смещению кода от наименьшего кода буквы. Иначе она двухуровневая:
+ * код делится на страницу (старшие биты) и позицию на странице (младшие 8 бит),
+ * память выделяется только под страницы, на которых есть буквы.
+ * Номер в таблице однобайтовый, поэтому символ принадлежит алфавиту, только если
+ * буква с этим номером совпадает с самим символом — отдельной метки "нет буквы"
+ * не нужно, и в алфавите может быть все 256 символов.
+ *
+ * Копия объекта разделяет таблицы с оригиналом: шифры хранят алфавит по значению,
+ * а таблицы строятся один раз на алфавит. Объект неизменяем, поэтому его можно
+ * использовать из нескольких потоков одновременно.
+ *
+ * Текст проверяется общей векторной проверкой (textValidator.h), если алфавит
+ * состоит из нескольких отрезков подряд идущих кодов, иначе — по таблице номеров.
+ *
+ * Формат файла алфавита (UTF-8): буквы записываются подряд в нужном порядке,
+ * пробелы и переводы строк между ними не учитываются, строка, начинающаяся с `#`, —
+ * комментарий:
+ * @code
+ * # русский алфавит и цифры
+ * АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ
+ * 0123456789
+ * @endcode
+ *
+ * В отличие от textValidator.h требует C++17.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include "textValidator.h"
+#include "utf8.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class Alphabet
+ * @brief Алфавит с таблицами "код → номер" и "номер → буква", общими для всех копий.
+ */
+class Alphabet {
+public:
+    static constexpr size_t maxSize = 256;             ///< Наибольшее число букв: номер занимает один байт.
+    static constexpr int invalidIndex = -1;            ///< Результат indexOf() для символа не из алфавита.
+    static constexpr std::uint32_t maxCode = 0x10FFFF; ///< Наибольший код символа Юникода.
+    static constexpr std::uint32_t denseLimit = 1 << 16; ///< Наибольший отрезок кодов для одноуровневой таблицы.
+
+    /**
+     * @brief Строит алфавит из букв в заданном порядке.
+     *
+     * @param letters Буквы алфавита; номер буквы — её позиция в строке.
+     * @throws std::invalid_argument Если букв нет или больше maxSize, буква повторяется,
+     * либо среди букв есть пробельный, управляющий или недопустимый в Юникоде символ.
+     */
+    explicit Alphabet(std::wstring_view letters) : tables(build(letters)) {}
+
+    /**
+     * @brief Строит алфавит из букв, записанных в UTF-8.
+     *
+     * @param letters Буквы в UTF-8; пробелы и переводы строк между буквами пропускаются.
+     * @throws std::invalid_argument Если строка не в UTF-8 или буквы не образуют алфавит.
+     */
+    static Alphabet fromUtf8(std::string_view letters) {
+        return Alphabet(decode(letters));
+    }
+
+    /**
+     * @brief Загружает алфавит из файла (формат описан в начале файла runtimeAlphabet.h).
+     *
+     * @param path Путь к файлу в UTF-8.
+     * @throws std::runtime_error Если файл не удалось прочитать.
+     * @throws std::invalid_argument Если содержимое не образует алфавит.
+     */
+    static Alphabet fromFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Не удалось открыть " + path);
+        }
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (file.bad()) {
+            throw std::runtime_error("Ошибка чтения " + path);
+        }
+        if (content.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            content.erase(0, 3); // метка порядка байтов
+        }
+        std::string letters;
+        for (size_t pos = 0; pos < content.size();) {
+            size_t end = content.find('\n', pos);
+            end = end == std::string::npos ? content.size() : end;
+            const size_t first = content.find_first_not_of(" \t\r", pos);
+            if (first >= end || content[first] != '#') {
+                letters.append(content, pos, end - pos);
+            }
+            pos = end + 1;
+        }
+        return fromUtf8(letters);
+    }
+
+    /**
+     * @brief Прописные русские буквы (33, с 'Ё' после 'Е').
+     */
+    static const Alphabet& russian() {
+        static const Alphabet alphabet(RUSSIAN_UPPER_LETTERS);
+        return alphabet;
+    }
+
+    /**
+     * @brief Прописные латинские буквы (26).
+     */
+    static const Alphabet& latin() {
+        static const Alphabet alphabet(LATIN_UPPER_LETTERS);
+        return alphabet;
+    }
+
+    /**
+     * @brief Прописные русские, затем латинские буквы (59), как в modPermutationCipher.
+     */
+    static const Alphabet& russianLatin() {
+        static const Alphabet alphabet(RUSSIAN_UPPER_LETTERS LATIN_UPPER_LETTERS);
+        return alphabet;
+    }
+
+    /**
+     * @brief Количество букв (модуль сдвига).
+     */
+    size_t size() const noexcept { return tables->letters.size(); }
+
+    /**
+     * @brief Буквы в порядке номеров.
+     */
+    const std::wstring& letters() const noexcept { return tables->letters; }
+
+    /**
+     * @brief Буква по номеру (номер меньше size()).
+     */
+    wchar_t letter(size_t index) const noexcept { return tables->letters[index]; }
+
+    /**
+     * @brief Одноуровневая таблица номеров для горячего цикла.
+     *
+     * @details Указатель копируется в локальную переменную и не перечитывается из памяти
+     * на каждом символе. Символ должен принадлежать алфавиту (проверен findInvalid()).
+     */
+    struct DenseLookup {
+        const unsigned char* table; ///< Номера по `code - base`.
+        std::uint32_t base;         ///< Первый код таблицы.
+
+        unsigned char operator()(wchar_t ch) const noexcept {
+            return table[static_cast<std::uint32_t>(ch) - base];
+        }
+    };
+
+    /**
+     * @brief Двухуровневая таблица номеров для горячего цикла (коды букв разбросаны шире denseLimit).
+     */
+    struct PagedLookup {
+        const unsigned char* pages;  ///< Страницы по 256 номеров.
+        const std::uint16_t* pageOf; ///< Номер страницы по `code >> 8`.
+
+        unsigned char operator()(wchar_t ch) const noexcept {
+            const std::uint32_t code = static_cast<std::uint32_t>(ch);
+            return pages[(static_cast<size_t>(pageOf[code >> 8]) << 8) | (code & 0xFF)];
+        }
+    };
+
+    /**
+     * @brief Вызывает `body` с таблицей номеров подходящего вида.
+     *
+     * @details Выбор между таблицами делается один раз на вызов, а не на символ:
+     * `body` — обобщённая лямбда, горячий цикл в ней собирается для каждого вида отдельно.
+     *
+     * @return Результат `body`.
+     */
+    template <class Body>
+    decltype(auto) withLookup(Body&& body) const {
+        if (tables->pageOf.empty()) {
+            return body(DenseLookup{tables->pages.data(), tables->base});
+        }
+        return body(PagedLookup{tables->pages.data(), tables->pageOf.data()});
+    }
+
+    /**
+     * @brief Номер символа в алфавите.
+     *
+     * @param ch Любой символ.
+     * @return int Номер буквы или invalidIndex, если символа нет в алфавите.
+     */
+    int indexOf(wchar_t ch) const noexcept {
+        const std::uint32_t code = static_cast<std::uint32_t>(ch);
+        if (code > maxCode) {
+            return invalidIndex;
+        }
+        unsigned char index;
+        if (tables->pageOf.empty()) {
+            if (code - tables->base >= tables->pages.size()) {
+                return invalidIndex;
+            }
+            index = DenseLookup{tables->pages.data(), tables->base}(ch);
+        } else {
+            index = PagedLookup{tables->pages.data(), tables->pageOf.data()}(ch);
+        }
+        return tables->letters[index] == ch ? index : invalidIndex;
+    }
+
+    /**
+     * @brief Находит первый символ, не входящий в алфавит.
+     *
+     * @return size_t Позиция символа или `length`, если все символы допустимы.
+     */
+    size_t findInvalid(const wchar_t* text, size_t length) const noexcept {
+        const std::vector<CodeRange>& ranges = tables->ranges;
+        if (ranges.size() <= vectorRanges) {
+            return findOutside(text, length, ranges.data(), ranges.size());
+        }
+        for (size_t i = 0; i < length; i++) {
+            if (indexOf(text[i]) == invalidIndex) {
+                return i;
+            }
+        }
+        return length;
+    }
+
+    /**
+     * @brief Отрезки подряд идущих кодов, из которых состоит алфавит, по возрастанию.
+     */
+    const std::vector<CodeRange>& ranges() const noexcept { return tables->ranges; }
+
+    /**
+     * @brief Наибольшая длина буквы в UTF-8 (1…4 байта).
+     */
+    size_t maxUtf8Length() const noexcept { return tables->maxUtf8Length; }
+
+    /**
+     * @brief Совпадают ли буквы и их порядок.
+     */
+    bool operator==(const Alphabet& other) const noexcept {
+        return tables == other.tables || tables->letters == other.tables->letters;
+    }
+
+    bool operator!=(const Alphabet& other) const noexcept { return !(*this == other); }
+
+private:
+    /**
+     * @brief Больше отрезков векторная проверка не перебирает: дешевле таблица номеров.
+     */
+    static constexpr size_t vectorRanges = 4;
+
+    /**
+     * @brief Таблицы алфавита, общие для всех копий.
+     */
+    struct Tables {
+        std::wstring letters;              ///< Буква по номеру.
+        std::uint32_t base = 0;            ///< Первый код одноуровневой таблицы номеров.
+        std::vector<std::uint16_t> pageOf; ///< Номер страницы по `code >> 8` (0 — пустая); пуст у одноуровневой таблицы.
+        std::vector<unsigned char> pages;  ///< Номера по `code - base` или страницы по 256 номеров (страница 0 — нули).
+        std::vector<CodeRange> ranges;     ///< Отрезки кодов алфавита.
+        size_t maxUtf8Length = 0;          ///< Наибольшая длина буквы в UTF-8.
+    };
+
+    std::shared_ptr<const Tables> tables; ///< Таблицы (разделяются копиями).
+
+    /**
+     * @brief Проверяет буквы и строит таблицы.
+     */
+    static std::shared_ptr<const Tables> build(std::wstring_view letters) {
+        if (letters.empty()) {
+            throw std::invalid_argument("Ошибка: алфавит не может быть пустым.");
+        }
+        if (letters.size() > maxSize) {
+            throw std::invalid_argument("Ошибка: в алфавите может быть не больше 256 символов.");
+        }
+        auto tables = std::make_shared<Tables>();
+        tables->letters.assign(letters.begin(), letters.end());
+        std::uint32_t first = maxCode;
+        std::uint32_t last = 0;
+        for (wchar_t c : letters) {
+            const std::uint32_t code = static_cast<std::uint32_t>(c);
+            if (code > maxCode || (code >= 0xD800 && code <= 0xDFFF) || code <= 0x20 || code == 0x7F
+                || (code >= 0x80 && code < 0xA0)) {
+                throw std::invalid_argument("Ошибка: в алфавите не может быть пробельных и управляющих символов.");
+            }
+            first = std::min(first, code);
+            last = std::max(last, code);
+            const size_t width = code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+            tables->maxUtf8Length = std::max(tables->maxUtf8Length, width);
+        }
+        const bool dense = last - first < denseLimit;
+        if (dense) {
+            tables->base = first;
+            tables->pages.assign(last - first + 1, 0);
+        } else {
+            tables->pageOf.assign((maxCode >> 8) + 1, 0);
+            tables->pages.assign(256, 0);
+        }
+        std::vector<bool> present(dense ? tables->pages.size() : 0, false);
+        for (size_t i = 0; i < letters.size(); i++) {
+            const std::uint32_t code = static_cast<std::uint32_t>(letters[i]);
+            size_t slot = code - first;
+            if (!dense) {
+                std::uint16_t& page = tables->pageOf[code >> 8];
+                if (page == 0) {
+                    page = static_cast<std::uint16_t>(tables->pages.size() >> 8);
+                    tables->pages.resize(tables->pages.size() + 256, 0);
+                    present.resize(tables->pages.size(), false);
+                }
+                slot = (static_cast<size_t>(page) << 8) | (code & 0xFF);
+            }
+            if (present[slot]) {
+                throw std::invalid_argument("Ошибка: символы алфавита не могут повторяться.");
+            }
+            present[slot] = true;
+            tables->pages[slot] = static_cast<unsigned char>(i);
+        }
+        std::wstring sorted = tables->letters;
+        std::sort(sorted.begin(), sorted.end());
+        for (wchar_t c : sorted) {
+            if (!tables->ranges.empty() && tables->ranges.back().last + 1 == c) {
+                tables->ranges.back().last = c;
+            } else {
+                tables->ranges.push_back(CodeRange{c, c});
+            }
+        }
+        return tables;
+    }
+
+    /**
+     * @brief Переводит буквы из UTF-8 в wchar_t, пропуская пробелы и переводы строк.
+     */
+    static std::wstring decode(std::string_view text) {
+        std::wstring result;
+        for (size_t pos = 0; pos < text.size();) {
+            std::uint32_t code;
+            const size_t length = decodeUtf8Char(text.data() + pos, text.size() - pos, code);
+            if (length == 0) {
+                throw std::invalid_argument("Ошибка: алфавит должен быть записан в UTF-8.");
+            }
+            pos += length;
+            if (code != ' ' && code != '\t' && code != '\n' && code != '\r') {
+                result += static_cast<wchar_t>(code);
+            }
+        }
+        return result;
+    }
+};
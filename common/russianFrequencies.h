@@ -0,0 +1,57 @@
+/**
+ * @file russianFrequencies.h
+ * @brief Частоты букв русского языка, общие для взлома шифров и их тестов.
+ *
+ * Порядок частот — порядок RUSSIAN_UPPER_LETTERS (textValidator.h): 'Ё' после 'Е'.
+ * Таблицу используют восстановление ключа шифра Гронсвельда (χ² по столбцам)
+ * и перебор ключей modPermutationCipher (модель биграмм), а тесты обоих —
+ * для генерации текста с частотами русского языка.
+ *
+ * Файл только заголовочный и совместим с C++11:
+ * @code
+ * #include "../common/russianFrequencies.h"
+ * @endcode
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include "textValidator.h"
+#include <array>
+#include <cstddef>
+#include <random>
+#include <string>
+
+/**
+ * @brief Частоты русских букв в порядке RUSSIAN_UPPER_LETTERS (доли единицы).
+ */
+constexpr std::array<double, 33> russianFrequencies = {{
+    0.0801, 0.0159, 0.0454, 0.0170, 0.0298, 0.0845, 0.0004, 0.0094, 0.0165, 0.0735, 0.0121,
+    0.0349, 0.0440, 0.0321, 0.0670, 0.1097, 0.0281, 0.0473, 0.0547, 0.0626, 0.0262, 0.0026,
+    0.0097, 0.0048, 0.0144, 0.0073, 0.0036, 0.0004, 0.0190, 0.0174, 0.0032, 0.0064, 0.0201}};
+
+static_assert(sizeof(RUSSIAN_UPPER_LETTERS) / sizeof(wchar_t) - 1 == russianFrequencies.size(),
+              "one frequency per letter of RUSSIAN_UPPER_LETTERS");
+
+/**
+ * @brief Случайный текст из прописных русских букв с частотами russianFrequencies.
+ *
+ * @param letters Количество букв.
+ * @param wordLength Через сколько букв ставится пробел (0 — без пробелов).
+ * @param gen Генератор случайных чисел (например, std::mt19937).
+ * @return std::wstring Текст; пробел после последней буквы тоже ставится.
+ */
+template <class Generator>
+std::wstring russianText(size_t letters, size_t wordLength, Generator& gen) {
+    static const wchar_t alphabet[] = RUSSIAN_UPPER_LETTERS;
+    std::discrete_distribution<size_t> frequency(russianFrequencies.begin(), russianFrequencies.end());
+    std::wstring text;
+    for (size_t i = 0; i < letters; i++) {
+        text += alphabet[frequency(gen)];
+        if (wordLength != 0 && i % wordLength == wordLength - 1) {
+            text += L' ';
+        }
+    }
+    return text;
+}
@@ -0,0 +1,224 @@
+/**
+ * @file streamMode.h
+ * @brief Потоковый режим программ шифров: разбор аргументов, файлы, вывод времени и счётчиков.
+ *
+ * @details
+ * Формат вызова общий для всех программ:
+ * `cipher -e|-d -k КЛЮЧ [--alphabet ФАЙЛ] [--threads N] [--timing] [--stats[=json]] [ВХОД [ВЫХОД]]`.
+ * - `--alphabet ФАЙЛ` — алфавит шифра из файла (формат — в runtimeAlphabet.h).
+ * - `--threads N` делит текст между N потоками (0 — по числу ядер), результат не меняется.
+ * - `--timing` печатает в stderr время чтения, шифрования и записи (для отображения в память — общее время).
+ * - `--stats` печатает в stderr счётчики шифра в формате Prometheus, `--stats=json` — в JSON
+ *   (счётчики собираются только при сборке с `make METRICS=1`, см. metrics.h).
+ * - Если файлы не указаны или указан `-`, используются стандартные потоки ввода и вывода.
+ *   Если указаны оба файла, они отображаются в память (`encryptFile()`/`decryptFile()` шифра).
+ *
+ * Программа передаёт в runStreamMode() функцию, которая создаёт шифр по ключу и алфавиту
+ * и вызывает StreamSession::run() с ним и своей функцией обработки потока.
+ * Сообщения об ошибках выводятся с префиксом "Ошибка: ", если его нет в самом сообщении.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include "metrics.h"
+#include "pipeline.h"
+#include "utf8.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Аргументы потокового режима.
+ */
+struct StreamOptions {
+    bool encrypt = true;                /**< true — `-e`, false — `-d`. */
+    const char* key = nullptr;          /**< Ключ (`-k`) в UTF-8. */
+    const char* alphabetFile = nullptr; /**< Файл алфавита (`--alphabet`) или nullptr. */
+    unsigned threads = 1;               /**< Число потоков шифрования. */
+    bool timing = false;                /**< Печатать время стадий. */
+    int stats = 0;                      /**< 0 — не печатать счётчики, 1 — Prometheus, 2 — JSON. */
+    const char* files[2] = {"-", "-"};  /**< Вход и выход (`-` — стандартный поток). */
+};
+
+/**
+ * @brief Разбирает аргументы командной строки.
+ *
+ * @return true Если задан режим (`-e` или `-d`) и ключ, а лишних аргументов нет.
+ */
+inline bool parseStreamOptions(int argc, char** argv, StreamOptions& options) {
+    int mode = 0;
+    int fileCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-e") == 0) {
+            mode = 1;
+        } else if (std::strcmp(argv[i], "-d") == 0) {
+            mode = 2;
+        } else if (std::strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            options.key = argv[++i];
+        } else if (std::strcmp(argv[i], "--alphabet") == 0 && i + 1 < argc) {
+            options.alphabetFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            if (options.threads == 0) {
+                options.threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+        } else if (std::strcmp(argv[i], "--timing") == 0) {
+            options.timing = true;
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            options.stats = 1;
+        } else if (std::strcmp(argv[i], "--stats=json") == 0) {
+            options.stats = 2;
+        } else if (fileCount < 2 && (argv[i][0] != '-' || argv[i][1] == '\0')) {
+            options.files[fileCount++] = argv[i];
+        } else {
+            return false;
+        }
+    }
+    options.encrypt = mode == 1;
+    return mode != 0 && options.key != nullptr;
+}
+
+/**
+ * @brief Переводит ключ из UTF-8 в wchar_t.
+ *
+ * @throws std::invalid_argument Если ключ не в UTF-8.
+ */
+inline std::wstring decodeKey(const char* key) {
+    const size_t length = std::strlen(key);
+    std::wstring result;
+    for (size_t pos = 0; pos < length;) {
+        std::uint32_t code;
+        const size_t size = decodeUtf8Char(key + pos, length - pos, code);
+        if (size == 0) {
+            throw std::invalid_argument("Ошибка: ключ должен быть записан в UTF-8.");
+        }
+        result += static_cast<wchar_t>(code);
+        pos += size;
+    }
+    return result;
+}
+
+/**
+ * @brief Входной и выходной файлы потокового режима.
+ */
+class StreamSession {
+private:
+    const StreamOptions& options; /**< Аргументы. */
+    std::FILE* in = stdin;        /**< Входной поток. */
+    std::FILE* out = stdout;      /**< Выходной поток. */
+
+public:
+    explicit StreamSession(const StreamOptions& options) : options(options) {}
+
+    StreamSession(const StreamSession&) = delete;
+    StreamSession& operator=(const StreamSession&) = delete;
+
+    /**
+     * @brief Закрывает файлы, если close() не был вызван (после ошибки).
+     */
+    ~StreamSession() {
+        if (in != stdin && in != nullptr) {
+            std::fclose(in);
+        }
+        if (out != stdout && out != nullptr) {
+            std::fclose(out);
+        }
+    }
+
+    /**
+     * @brief Шифрует или расшифровывает вход целиком.
+     *
+     * @param cipher Шифр с методами `encryptFile`/`decryptFile(input, output, threads)`.
+     * @param process Функция `PipelineTiming(const Cipher&, bool encrypt, unsigned threads,
+     * std::FILE* in, std::FILE* out)` для каналов и одиночных файлов.
+     * @throws std::runtime_error Если файл не удалось открыть, прочитать или записать.
+     */
+    template <class Cipher, class Process>
+    void run(const Cipher& cipher, Process process) {
+        if (std::strcmp(options.files[0], "-") != 0 && std::strcmp(options.files[1], "-") != 0) {
+            const auto start = std::chrono::steady_clock::now();
+            if (options.encrypt) {
+                cipher.encryptFile(options.files[0], options.files[1], options.threads);
+            } else {
+                cipher.decryptFile(options.files[0], options.files[1], options.threads);
+            }
+            if (options.timing) {
+                const std::chrono::duration<double> total = std::chrono::steady_clock::now() - start;
+                std::fprintf(stderr, "всего (отображение в память): %.3f с\n", total.count());
+            }
+            return;
+        }
+        if (std::strcmp(options.files[0], "-") != 0 && (in = std::fopen(options.files[0], "rb")) == nullptr) {
+            throw std::runtime_error(std::string("Не удалось открыть ") + options.files[0]);
+        }
+        if (std::strcmp(options.files[1], "-") != 0 && (out = std::fopen(options.files[1], "wb")) == nullptr) {
+            throw std::runtime_error(std::string("Не удалось открыть ") + options.files[1]);
+        }
+        const PipelineTiming stages = process(cipher, options.encrypt, options.threads, in, out);
+        if (options.timing) {
+            printPipelineTiming(stderr, stages);
+        }
+    }
+
+    /**
+     * @brief Закрывает файлы.
+     *
+     * @throws std::runtime_error Если выходной файл не удалось дописать.
+     */
+    void close() {
+        if (in != stdin) {
+            std::fclose(in);
+        }
+        in = stdin;
+        std::FILE* file = out;
+        out = stdout;
+        if (file != stdout && std::fclose(file) != 0) {
+            throw std::runtime_error("Ошибка записи.");
+        }
+    }
+};
+
+/**
+ * @brief Потоковый режим программы шифра.
+ *
+ * @param run Функция `void(const StreamOptions&, StreamSession&)`: создаёт шифр
+ * и вызывает StreamSession::run().
+ * @return int 0 при успехе, 1 при ошибке (сообщение выводится в stderr).
+ */
+template <class Run>
+int runStreamMode(int argc, char** argv, Run run) {
+    StreamOptions options;
+    if (!parseStreamOptions(argc, argv, options)) {
+        std::cerr << "Использование: " << argv[0]
+                  << " [-e|-d -k КЛЮЧ [--alphabet ФАЙЛ] [--threads N] [--timing] [--stats[=json]] [ВХОД [ВЫХОД]]]\n";
+        return 1;
+    }
+    auto printStats = [&options] {
+        if (options.stats != 0) {
+            const MetricsSnapshot snapshot = collectMetrics();
+            const MetricsFormat format = options.stats == 1 ? MetricsFormat::prometheus : MetricsFormat::json;
+            std::fputs(formatMetrics(snapshot, format).c_str(), stderr);
+        }
+    };
+    try {
+        StreamSession session(options);
+        run(options, session);
+        session.close();
+    } catch (const std::exception& e) {
+        static const char prefix[] = "Ошибка";
+        const bool prefixed = std::strncmp(e.what(), prefix, sizeof(prefix) - 1) == 0;
+        std::cerr << (prefixed ? "" : "Ошибка: ") << e.what() << std::endl;
+        printStats();
+        return 1;
+    }
+    printStats();
+    return 0;
+}
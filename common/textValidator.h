@@ -0,0 +1,273 @@
+/**
+ * @file textValidator.h
+ * @brief Общая векторная проверка текста на допустимые символы для всех лабораторных работ.
+ *
+ * Алфавит задаётся набором отрезков кодов `[first, last]`. Символ допустим, если
+ * его код попадает хотя бы в один отрезок; проверка отрезка — одно беззнаковое
+ * сравнение `code - first <= last - first`. Готовые наборы: прописные русские
+ * буквы ('А'…'Я' и 'Ё'), прописные латинские ('A'…'Z') и оба алфавита вместе.
+ * Здесь же записаны сами буквы этих алфавитов в алфавитном порядке.
+ *
+ * @details
+ * В отличие от `iswupper`/`iswalpha` результат не зависит от локали. Реализация
+ * выбирается при первом вызове по результату CPUID: AVX2 (32 символа за итерацию),
+ * SSE4.2 (16 символов) или скалярный цикл. Векторный вариант, найдя блок
+ * с недопустимым символом, передаёт его более узкому, поэтому все варианты
+ * возвращают одну и ту же позицию. Векторные варианты собираются только
+ * при 32-битном wchar_t.
+ *
+ * Файл только заголовочный и совместим с C++11, чтобы его можно было подключить
+ * из любой лабораторной работы без изменения команды сборки:
+ * @code
+ * #include "../common/textValidator.h"
+ * @endcode
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cwchar>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#if WCHAR_MAX > 0xFFFF
+#define TEXT_VALIDATOR_X86 1
+#endif
+#endif
+
+/**
+ * @brief Отрезок кодов символов `[first, last]`.
+ */
+struct CodeRange {
+    wchar_t first; /**< Первый код отрезка. */
+    wchar_t last;  /**< Последний код отрезка. */
+};
+
+/**
+ * @brief Прописные русские буквы по алфавиту (33, 'Ё' после 'Е').
+ *
+ * @details Вместе с LATIN_UPPER_LETTERS — единственное определение алфавитов:
+ * из этих строк собираются алфавиты шифров (laba4_chast1/alphabet.h,
+ * runtimeAlphabet.h), а отрезки ниже сверяются с ними при компиляции
+ * в laba4_chast1/alphabet.h. Макрос, а не массив, чтобы строки можно было
+ * склеить в объединённый алфавит и в C++11.
+ */
+#define RUSSIAN_UPPER_LETTERS L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ"
+
+/**
+ * @brief Прописные латинские буквы по алфавиту (26).
+ */
+#define LATIN_UPPER_LETTERS L"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+
+/**
+ * @brief Прописные буквы русского алфавита: 'Ё' и 'А'…'Я'.
+ */
+constexpr std::array<CodeRange, 2> cyrillicUpper = {{{L'Ё', L'Ё'}, {L'А', L'Я'}}};
+
+/**
+ * @brief Прописные буквы латинского алфавита: 'A'…'Z'.
+ */
+constexpr std::array<CodeRange, 1> latinUpper = {{{L'A', L'Z'}}};
+
+/**
+ * @brief Прописные буквы русского и латинского алфавитов.
+ */
+constexpr std::array<CodeRange, 3> cyrillicLatinUpper = {{{L'A', L'Z'}, {L'Ё', L'Ё'}, {L'А', L'Я'}}};
+
+/**
+ * @brief Доступные реализации проверки.
+ */
+enum class ValidatorKernel {
+    scalar, /**< Переносимый скалярный цикл. */
+    sse42,  /**< 16 символов за итерацию (SSE4.2). */
+    avx2    /**< 32 символа за итерацию (AVX2). */
+};
+
+/**
+ * @brief Скалярная проверка: позиция первого символа вне отрезков или `length`.
+ */
+inline size_t findOutsideScalar(const wchar_t* text, size_t length, const CodeRange* ranges, size_t count) {
+    for (size_t i = 0; i < length; i++) {
+        const std::uint32_t code = static_cast<std::uint32_t>(text[i]);
+        bool inside = false;
+        for (size_t r = 0; r < count; r++) {
+            const std::uint32_t first = static_cast<std::uint32_t>(ranges[r].first);
+            inside |= code - first <= static_cast<std::uint32_t>(ranges[r].last) - first;
+        }
+        if (!inside) {
+            return i;
+        }
+    }
+    return length;
+}
+
+#ifdef TEXT_VALIDATOR_X86
+
+/**
+ * @brief Маска символов, попавших в отрезок: `code - first <= span` без знака (SSE4.2).
+ */
+__attribute__((target("sse4.2")))
+inline __m128i insideRange(__m128i code, __m128i first, __m128i span) {
+    const __m128i d = _mm_sub_epi32(code, first);
+    return _mm_cmpeq_epi32(_mm_min_epu32(d, span), d);
+}
+
+/**
+ * @brief Проверка по 16 символов за итерацию (SSE4.2).
+ *
+ * @details Четыре вектора заведены отдельными переменными, а не массивом:
+ * иначе компилятор держит их в памяти, и проверка замедляется вдвое.
+ */
+__attribute__((target("sse4.2")))
+inline size_t findOutsideSse42(const wchar_t* text, size_t length, const CodeRange* ranges, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 4));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 8));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + 12));
+        __m128i inA = _mm_setzero_si128(), inB = inA, inC = inA, inD = inA;
+        for (size_t r = 0; r < count; r++) {
+            const __m128i first = _mm_set1_epi32(ranges[r].first);
+            const __m128i span = _mm_set1_epi32(ranges[r].last - ranges[r].first);
+            inA = _mm_or_si128(inA, insideRange(a, first, span));
+            inB = _mm_or_si128(inB, insideRange(b, first, span));
+            inC = _mm_or_si128(inC, insideRange(c, first, span));
+            inD = _mm_or_si128(inD, insideRange(d, first, span));
+        }
+        if (!_mm_test_all_ones(_mm_and_si128(_mm_and_si128(inA, inB), _mm_and_si128(inC, inD)))) {
+            break;
+        }
+    }
+    return i + findOutsideScalar(text + i, length - i, ranges, count);
+}
+
+/**
+ * @brief Маска символов, попавших в отрезок (AVX2).
+ */
+__attribute__((target("avx2")))
+inline __m256i insideRange(__m256i code, __m256i first, __m256i span) {
+    const __m256i d = _mm256_sub_epi32(code, first);
+    return _mm256_cmpeq_epi32(_mm256_min_epu32(d, span), d);
+}
+
+/**
+ * @brief Проверка по 32 символа за итерацию (AVX2).
+ */
+__attribute__((target("avx2")))
+inline size_t findOutsideAvx2(const wchar_t* text, size_t length, const CodeRange* ranges, size_t count) {
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 8));
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 16));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + 24));
+        __m256i inA = _mm256_setzero_si256(), inB = inA, inC = inA, inD = inA;
+        for (size_t r = 0; r < count; r++) {
+            const __m256i first = _mm256_set1_epi32(ranges[r].first);
+            const __m256i span = _mm256_set1_epi32(ranges[r].last - ranges[r].first);
+            inA = _mm256_or_si256(inA, insideRange(a, first, span));
+            inB = _mm256_or_si256(inB, insideRange(b, first, span));
+            inC = _mm256_or_si256(inC, insideRange(c, first, span));
+            inD = _mm256_or_si256(inD, insideRange(d, first, span));
+        }
+        const __m256i all = _mm256_and_si256(_mm256_and_si256(inA, inB), _mm256_and_si256(inC, inD));
+        if (!_mm256_testc_si256(all, _mm256_set1_epi32(-1))) {
+            break;
+        }
+    }
+    // Остаток проверяется SSE-кодом без VEX-префикса: без очистки верхних половин
+    // регистров каждый вызов платит за переход между режимами AVX и SSE.
+    _mm256_zeroupper();
+    return i + findOutsideSse42(text + i, length - i, ranges, count);
+}
+
+#endif
+
+/**
+ * @brief Возвращает реализацию, выбранную по CPUID.
+ */
+inline ValidatorKernel detectValidatorKernel() {
+#ifdef TEXT_VALIDATOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ValidatorKernel::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ValidatorKernel::sse42;
+    }
+#endif
+    return ValidatorKernel::scalar;
+}
+
+/**
+ * @brief Возвращает название реализации ("scalar", "sse4.2", "avx2").
+ */
+inline const char* validatorKernelName(ValidatorKernel kernel) {
+    switch (kernel) {
+    case ValidatorKernel::avx2:
+        return "avx2";
+    case ValidatorKernel::sse42:
+        return "sse4.2";
+    default:
+        return "scalar";
+    }
+}
+
+/**
+ * @brief Находит первый символ вне заданных отрезков заданной реализацией.
+ *
+ * @details Нужна для тестов и замеров; реализация должна поддерживаться процессором.
+ */
+inline size_t findOutside(ValidatorKernel kernel, const wchar_t* text, size_t length,
+                          const CodeRange* ranges, size_t count) {
+    switch (kernel) {
+#ifdef TEXT_VALIDATOR_X86
+    case ValidatorKernel::avx2:
+        return findOutsideAvx2(text, length, ranges, count);
+    case ValidatorKernel::sse42:
+        return findOutsideSse42(text, length, ranges, count);
+#endif
+    default:
+        return findOutsideScalar(text, length, ranges, count);
+    }
+}
+
+/**
+ * @brief Находит первый символ вне заданных отрезков лучшей реализацией.
+ *
+ * @param text Символы.
+ * @param length Количество символов.
+ * @param ranges Отрезки допустимых кодов.
+ * @param count Количество отрезков.
+ * @return size_t Позиция первого недопустимого символа или `length`, если все допустимы.
+ */
+inline size_t findOutside(const wchar_t* text, size_t length, const CodeRange* ranges, size_t count) {
+    static const ValidatorKernel kernel = detectValidatorKernel();
+    return findOutside(kernel, text, length, ranges, count);
+}
+
+/**
+ * @brief То же для набора отрезков, заданного массивом (например, cyrillicUpper).
+ */
+template <size_t N>
+size_t findOutside(const wchar_t* text, size_t length, const std::array<CodeRange, N>& ranges) {
+    return findOutside(text, length, ranges.data(), N);
+}
+
+/**
+ * @brief Проверяет, что все символы строки входят в заданные отрезки.
+ *
+ * @param text Строка (пустая считается корректной).
+ * @param ranges Отрезки допустимых кодов.
+ * @return true Если недопустимых символов нет.
+ */
+template <size_t N>
+bool isValidText(const std::wstring& text, const std::array<CodeRange, N>& ranges) {
+    return findOutside(text.data(), text.size(), ranges) == text.size();
+}
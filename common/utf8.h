@@ -0,0 +1,95 @@
+/**
+ * @file utf8.h
+ * @brief Разбор символов UTF-8, общий для всех лабораторных работ.
+ *
+ * Символ допустим, если первый байт может начинать последовательность
+ * (0x00–0x7F, 0xC2–0xF4), а за ним следует нужное число байт продолжения
+ * (0x80–0xBF). Длинные и короткие формы одного кода не различаются: шифры
+ * не меняют байты, которые не смогли разобрать, а отвергают весь текст.
+ *
+ * Файл только заголовочный и совместим с C++11:
+ * @code
+ * #include "../common/utf8.h"
+ * @endcode
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Длина символа UTF-8 по первому байту.
+ *
+ * @param lead Первый байт символа.
+ * @return size_t Длина в байтах (1–4) или 0, если байт не может начинать символ.
+ */
+inline size_t utf8CharLength(unsigned char lead) {
+    return lead < 0x80 ? 1 : lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+}
+
+/**
+ * @brief Разбирает символ UTF-8 в начале текста.
+ *
+ * @param text Байты UTF-8.
+ * @param length Количество байт (не меньше 1).
+ * @param code Код символа, если он разобран.
+ * @return size_t Длина символа в байтах или 0, если последовательность недопустима
+ * или обрывается в конце текста (отличить одно от другого можно по utf8CharLength()).
+ */
+inline size_t decodeUtf8Char(const char* text, size_t length, std::uint32_t& code) {
+    const unsigned char lead = static_cast<unsigned char>(text[0]);
+    const size_t size = utf8CharLength(lead);
+    if (size == 0 || size > length) {
+        return 0;
+    }
+    code = size == 1 ? lead : lead & (0x7F >> size);
+    for (size_t k = 1; k < size; k++) {
+        const unsigned char next = static_cast<unsigned char>(text[k]);
+        if ((next & 0xC0) != 0x80) {
+            return 0;
+        }
+        code = (code << 6) | (next & 0x3F);
+    }
+    return size;
+}
+
+/**
+ * @brief Записывает символ в UTF-8.
+ *
+ * @param code Код символа (не больше 0x10FFFF).
+ * @param out Буфер не меньше 4 байт.
+ * @return size_t Длина символа в байтах (1–4).
+ */
+inline size_t encodeUtf8Char(std::uint32_t code, char* out) {
+    if (code < 0x80) {
+        out[0] = static_cast<char>(code);
+        return 1;
+    }
+    const size_t size = code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+    for (size_t k = size - 1; k > 0; k--) {
+        out[k] = static_cast<char>(0x80 | (code & 0x3F));
+        code >>= 6;
+    }
+    const std::uint32_t lead = size == 2 ? 0xC0 : size == 3 ? 0xE0 : 0xF0;
+    out[0] = static_cast<char>(lead | code);
+    return size;
+}
+
+/**
+ * @brief Длина неполной последовательности UTF-8 в конце буфера (0…3 байта).
+ *
+ * @details Некорректные последовательности не считаются неполными: их отвергнет шифр.
+ */
+inline size_t utf8Tail(const char* data, size_t length) {
+    for (size_t back = 1; back <= 3 && back <= length; back++) {
+        const unsigned char b = static_cast<unsigned char>(data[length - back]);
+        if ((b & 0xC0) == 0x80) {
+            continue; // байт продолжения: ищем первый байт символа
+        }
+        return utf8CharLength(b) > back ? back : 0;
+    }
+    return 0;
+}
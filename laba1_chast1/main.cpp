@@ -1,15 +1,13 @@
 #include <iostream>
 #include <cctype>
 #include "modAlphaChiper.h"
+#include "../common/textValidator.h"
 #include <locale>
 using namespace std;
-// проверка, чтобы строка состояла только из прописных букв
+// проверка, чтобы строка состояла только из прописных русских букв (алфавит шифра)
 bool isValid(const wstring& s)
 {
-    for (auto c:s)
-        if (!iswalpha(c) || !iswupper(c))
-            return false;
-    return true;
+    return isValidText(s, cyrillicUpper);
 }
 int main(int argc, char **argv)
 {
@@ -0,0 +1,187 @@
+/**
+ * @file bench_modAlphakey.cpp
+ * @brief Замер пропускной способности маршрутной перестановки.
+ *
+ * Сравнивает прежний обход таблицы по столбцам (с шагом `key1` по всему тексту)
+ * с текущей реализацией `modAlphakey`: готовым маршрутом для коротких текстов
+ * и поблочным обходом для длинных. Замеры делаются для текстов 1 КБ, 1 МБ и 100 МБ
+ * с узкой и широкой таблицей.
+ *
+ * Отдельно замеряется подбор ширины таблицы по шифротексту (ширины 1…64): расшифрование
+ * каждой ширины в новую std::wstring с оценкой пар символов против rankWidths(),
+ * который читает пары прямо из шифротекста, по всем строкам и по первым 4096.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "modAlphakey.h"
+#include "widthSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+volatile wchar_t sink; /**< Не даёт компилятору выбросить результат перестановки. */
+
+/**
+ * @brief Прежняя реализация зашифрования, оставленная как эталон для сравнения.
+ */
+std::wstring referenceEncrypt(const std::wstring& open_text, int key1) {
+    std::wstring tabl = open_text;
+    int dl = open_text.length();
+    int nstrok = (dl - 1) / key1 + 1;
+    int x = 0;
+    for (int i = key1; i > 0; i--) {
+        for (int j = 0; j < nstrok; j++) {
+            int index = i + key1 * j;
+            if (index - 1 < dl) {
+                tabl[x] = open_text[index - 1];
+                x++;
+            }
+        }
+    }
+    return tabl;
+}
+
+/**
+ * @brief Генерирует случайный текст из заглавных латинских букв.
+ */
+std::wstring randomText(size_t length) {
+    std::mt19937 gen(42);
+    std::wstring text(length, L' ');
+    for (auto& c : text) {
+        c = L'A' + gen() % 26;
+    }
+    return text;
+}
+
+/**
+ * @brief Выполняет функцию несколько раз и возвращает лучший результат в МБ/с.
+ */
+template <class Run>
+double measure(size_t bytes, int repeats, const Run& run) {
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto stop = std::chrono::steady_clock::now();
+        double mbps = bytes / std::chrono::duration<double>(stop - start).count() / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Прежний подбор ширины: полная расшифровка для каждой ширины и оценка пар символов.
+ */
+int referenceBestWidth(const std::wstring& cipher_text, const BigramScorer& model, int maxWidth) {
+    int best = 1;
+    double bestScore = -1e300;
+    for (int key = 1; key <= maxWidth; key++) {
+        const std::wstring open_text = modAlphakey(key).decrypt(cipher_text);
+        double score = 0;
+        for (size_t i = 1; i < open_text.size(); i++) {
+            score += model.score(BigramScorer::classOf(open_text[i - 1]), BigramScorer::classOf(open_text[i]));
+        }
+        if (score / (open_text.size() - 1) > bestScore) {
+            bestScore = score / (open_text.size() - 1);
+            best = key;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Текст из случайных слов небольшого словаря (у пар символов есть статистика).
+ */
+std::wstring randomWords(size_t length, unsigned seed) {
+    const std::vector<std::wstring> vocabulary = {L"шифр", L"ключ", L"текст", L"таблица", L"столбец", L"строка",
+                                                  L"маршрут", L"перестановка", L"открытый", L"символ"};
+    std::mt19937 gen(seed);
+    std::wstring text;
+    while (text.size() < length) {
+        text += vocabulary[gen() % vocabulary.size()];
+        text += L' ';
+    }
+    text.resize(length);
+    return text;
+}
+
+/**
+ * @brief Время одного вызова в секундах (лучшее из нескольких).
+ */
+template <class Run>
+double seconds(int repeats, const Run& run) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    std::printf("%10s %6s %14s %14s %14s %8s\n", "size", "key", "strided, MB/s", "encrypt, MB/s", "decrypt, MB/s",
+                "gain");
+    for (size_t bytes : {size_t(1) << 10, size_t(1) << 20, size_t(100) << 20}) {
+        const size_t length = bytes / sizeof(wchar_t);
+        const std::wstring text = randomText(length);
+        std::wstring out(length, L'\0');
+        std::wstring back(length, L'\0');
+        const int repeats = bytes <= (1u << 10) ? 20000 : bytes <= (1u << 20) ? 50 : 3;
+        for (int key : {7, 1000}) {
+            modAlphakey cipher(key);
+            cipher.encrypt(text.data(), length, &out[0]);
+            cipher.decrypt(out.data(), length, &back[0]);
+            if (out != referenceEncrypt(text, key) || back != text) {
+                std::fprintf(stderr, "results differ for %zu bytes, key %d\n", bytes, key);
+                return 1;
+            }
+            double stridedSpeed = measure(bytes, repeats, [&] {
+                sink = referenceEncrypt(text, key)[0];
+            });
+            double encryptSpeed = measure(bytes, repeats, [&] {
+                cipher.encrypt(text.data(), length, &out[0]);
+                sink = out[0];
+            });
+            double decryptSpeed = measure(bytes, repeats, [&] {
+                cipher.decrypt(out.data(), length, &back[0]);
+                sink = back[0];
+            });
+            std::printf("%9zuK %6d %14.1f %14.1f %14.1f %7.2fx\n", bytes >> 10, key, stridedSpeed, encryptSpeed,
+                        decryptSpeed, encryptSpeed / stridedSpeed);
+        }
+    }
+
+    const BigramScorer model(randomWords(100000, 1));
+    std::printf("\n%10s %14s %14s %14s %8s\n", "chars", "decrypt, s", "all rows, s", "4096 rows, s", "gain");
+    for (size_t length : {size_t(1) << 20, size_t(16) << 20}) {
+        const std::wstring encrypted = modAlphakey(29).encrypt(randomWords(length, 2));
+        WidthOptions all;
+        all.sampleRows = 0;
+        WidthOptions sampled;
+        int found[3] = {};
+        const int repeats = length <= (1u << 20) ? 5 : 1;
+        double referenceTime = seconds(repeats, [&] { found[0] = referenceBestWidth(encrypted, model, 64); });
+        double allTime =
+            seconds(repeats, [&] { found[1] = rankWidths(std::wstring_view(encrypted), model, all)[0].key1; });
+        double sampledTime =
+            seconds(repeats, [&] { found[2] = rankWidths(std::wstring_view(encrypted), model, sampled)[0].key1; });
+        if (found[0] != 29 || found[1] != 29 || found[2] != 29) {
+            std::fprintf(stderr, "wrong width for %zu chars: %d %d %d\n", length, found[0], found[1], found[2]);
+            return 1;
+        }
+        std::printf("%10zu %14.3f %14.3f %14.3f %7.1fx\n", length, referenceTime, allTime, sampledTime,
+                    referenceTime / allTime);
+    }
+    return 0;
+}
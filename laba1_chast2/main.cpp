@@ -1,14 +1,10 @@
 #include "modAlphakey.h"
+#include "../common/runtimeAlphabet.h"
 using namespace std;
-// Проверка, является ли строка валидной (состоит только из заглавных букв)
+// Проверка, является ли строка валидной (состоит только из заглавных русских и латинских букв)
 bool isValid(const wstring& s)
 {
-    for(auto c : s) {
-        if(!isalpha(c) || !isupper(c)) {
-            return false;
-        }
-    }
-    return true;
+    return Alphabet::russianLatin().findInvalid(s.data(), s.size()) == s.size();
 }
 int main()
 {
@@ -19,7 +15,7 @@ int main()
     int op;
     wcout << L"Cipher ready. Input key: ";
     wcin >> key;
-    if(!wcin.good()) {
+    if(!wcin.good() || key <= 0) {
         wcerr << L"key not valid\n";
         return 0;
     }
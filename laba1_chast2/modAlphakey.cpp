@@ -1,33 +1,244 @@
 #include "modAlphakey.h"
+#include "../common/utf8.h"
+#include <cstring>
 using namespace std;
-std::wstring modAlphakey::encrypt(const std::wstring& open_text)
-{
-    wstring tabl = open_text;
-    int dl, nstrok, index, x;
-    dl = open_text.length();      // введенный текст
-    nstrok = (dl - 1) / key1 + 1; // количество столбцов
-    x = 0;
-    for(int i = key1; i > 0; i--) {       // столбцы
-        for(int j = 0; j < nstrok; j++) { // строки
-            index = i + key1 * j;
-            if(index - 1 < dl) {
-                tabl[x] = open_text[index - 1];
-                x++;
+modAlphakey::modAlphakey(const int& key):key1(key)
+{
+    if(key1 <= 0) {
+        throw invalid_argument("Key must be positive");
+    }
+}
+// Маршрут: текст записывается в таблицу по строкам (key1 столбцов),
+// а читается по столбцам справа налево, каждый столбец сверху вниз.
+// Последний маршрут хранится у каждого потока свой, поэтому один объект шифра
+// можно использовать из нескольких потоков без блокировок.
+const modAlphakey::Route& modAlphakey::prepare(int key1, size_t length)
+{
+    static thread_local Route cache;
+    if(cache.key1 == key1 && cache.length == length) {
+        return cache; // маршрут для этой таблицы и длины уже построен
+    }
+    vector<size_t>& columnStart = cache.columnStart;
+    vector<size_t>& route = cache.route;
+    size_t cols = key1;
+    size_t used = min(cols, length); // столбцы правее used пустые
+    columnStart.assign(used, 0);
+    size_t x = 0;
+    for(size_t c = used; c-- > 0;) {  // столбцы справа налево
+        columnStart[c] = x;
+        x += (length - c + cols - 1) / cols; // высота столбца
+    }
+    route.clear();
+    if(length <= routeLimit) {
+        route.resize(length);
+        x = 0;
+        for(size_t c = used; c-- > 0;) {
+            for(size_t pos = c; pos < length; pos += cols) {
+                route[x++] = pos;
+            }
+        }
+    }
+    cache.key1 = key1;
+    cache.length = length;
+    return cache;
+}
+// Короткие тексты переставляются по готовому маршруту.
+// Длинные - блоками по tileRows строк: блок таблицы читается один раз,
+// а запись идёт короткими непрерывными отрезками в каждый столбец.
+template <class T>
+void modAlphakey::transpose(const T* in, size_t length, T* out, bool forward) const
+{
+    const Route& prepared = prepare(key1, length);
+    const vector<size_t>& columnStart = prepared.columnStart;
+    if(length <= routeLimit) {
+        const size_t* r = prepared.route.data();
+        if(forward) {
+            for(size_t x = 0; x < length; x++) {
+                out[x] = in[r[x]];
+            }
+        } else {
+            for(size_t x = 0; x < length; x++) {
+                out[r[x]] = in[x];
+            }
+        }
+        return;
+    }
+    size_t cols = key1;
+    size_t rows = (length + cols - 1) / cols;
+    for(size_t r0 = 0; r0 < rows; r0 += tileRows) {
+        size_t r1 = min(rows, r0 + tileRows);
+        for(size_t c = 0; c < columnStart.size(); c++) {
+            size_t end = min(r1, (length - c + cols - 1) / cols); // последний столбец может быть короче
+            size_t start = columnStart[c];
+            if(forward) {
+                for(size_t r = r0; r < end; r++) {
+                    out[start + r] = in[r * cols + c];
+                }
+            } else {
+                for(size_t r = r0; r < end; r++) {
+                    out[r * cols + c] = in[start + r];
+                }
             }
         }
     }
+}
+std::wstring modAlphakey::encrypt(const std::wstring& open_text) const
+{
+    wstring tabl(open_text.size(), L'\0');
+    transpose(open_text.data(), open_text.size(), &tabl[0], true);
+    return tabl;
+}
+std::wstring modAlphakey::decrypt(const std::wstring& cipher_text) const
+{
+    wstring tabl(cipher_text.size(), L'\0');
+    transpose(cipher_text.data(), cipher_text.size(), &tabl[0], false);
     return tabl;
 }
-std::wstring modAlphakey::decrypt(const std::wstring& cipher_text)
+void modAlphakey::encrypt(const wchar_t* open_text, size_t length, wchar_t* out) const
+{
+    transpose(open_text, length, out, true);
+}
+void modAlphakey::decrypt(const wchar_t* cipher_text, size_t length, wchar_t* out) const
+{
+    transpose(cipher_text, length, out, false);
+}
+// Проверяет текст и считает символы; width - длина в байтах, общая для всех символов,
+// или 0, если длины разные
+size_t modAlphakey::countChars(std::string_view text, size_t& width)
+{
+    size_t length = 0;
+    width = 0;
+    bool uniform = true;
+    for(size_t pos = 0; pos < text.size(); length++) {
+        uint32_t code;
+        size_t len = decodeUtf8Char(text.data() + pos, text.size() - pos, code);
+        if(len == 0) {
+            throw invalid_argument("Invalid UTF-8 text");
+        }
+        uniform = uniform && (width == 0 || width == len);
+        width = len;
+        pos += len;
+    }
+    width = uniform ? width : 0;
+    return length;
+}
+// Символы одинаковой длины (width байт) или разной (width = 0) переставляются без таблицы
+// смещений: хранится только текущая позиция в байтах для каждого столбца шифротекста.
+// Зашифрование читает открытый текст по строкам и дописывает символ в его столбец,
+// расшифрование пишет открытый текст по строкам, беря символ из текущей позиции столбца.
+template <size_t width>
+void modAlphakey::transposeChars(const char* in, size_t bytes, size_t length, char* out, bool forward) const
 {
-    wstring tabl = cipher_text;
-    int dl, nstrok, index, x;
-    dl = cipher_text.length();
-    nstrok = (dl - 1) / key1 + 1; // количество столбцов
-    x = 0;
-    for(int i = key1; i > 0; i--) {       // столбцы
-  
+    size_t cols = key1;
+    size_t used = min(cols, length); // столбцы правее used пустые
+    auto charLength = [](const char* p) {
+        return width != 0 ? width : utf8CharLength(static_cast<unsigned char>(*p));
+    };
+    vector<size_t> cursor(used, 0);
+    if(forward) {
+        if(width != 0) {
+            for(size_t c = 0; c < used; c++) {
+                cursor[c] = (length - c + cols - 1) / cols * width; // высота столбца в байтах
+            }
+        } else {
+            for(size_t pos = 0, c = 0; pos < bytes; c = c + 1 == cols ? 0 : c + 1) {
+                size_t len = charLength(in + pos);
+                cursor[c] += len;
+                pos += len;
+            }
         }
+        size_t x = 0;
+        for(size_t c = used; c-- > 0;) { // столбцы справа налево
+            size_t size = cursor[c];
+            cursor[c] = x;
+            x += size;
+        }
+        for(size_t pos = 0, c = 0; pos < bytes; c = c + 1 == cols ? 0 : c + 1) {
+            size_t len = charLength(in + pos);
+            memcpy(out + cursor[c], in + pos, len);
+            cursor[c] += len;
+            pos += len;
+        }
+    } else {
+        size_t pos = 0;
+        for(size_t c = used; c-- > 0;) {
+            cursor[c] = pos;
+            size_t height = (length - c + cols - 1) / cols;
+            if(width != 0) {
+                pos += height * width;
+            } else {
+                for(size_t r = 0; r < height; r++) {
+                    pos += charLength(in + pos);
+                }
+            }
+        }
+        for(size_t x = 0, c = 0; x < bytes; c = c + 1 == cols ? 0 : c + 1) {
+            size_t len = charLength(in + cursor[c]);
+            memcpy(out + x, in + cursor[c], len);
+            cursor[c] += len;
+            x += len;
+        }
+    }
+}
+// ASCII переставляется тем же блочным transpose(), что и wchar_t; символы другой
+// длины - без промежуточных массивов на каждый символ (см. transposeChars)
+std::string modAlphakey::transposeUtf8(std::string_view text, bool forward) const
+{
+    size_t width;
+    size_t length = countChars(text, width);
+    string tabl(text.size(), '\0');
+    char* out = &tabl[0];
+    switch(width) {
+    case 1:
+        transpose(text.data(), length, out, forward);
+        break;
+    case 2:
+        transposeChars<2>(text.data(), text.size(), length, out, forward);
+        break;
+    case 3:
+        transposeChars<3>(text.data(), text.size(), length, out, forward);
+        break;
+    case 4:
+        transposeChars<4>(text.data(), text.size(), length, out, forward);
+        break;
+    default:
+        transposeChars<0>(text.data(), text.size(), length, out, forward);
+        break;
     }
     return tabl;
 }
+std::string modAlphakey::encrypt(std::string_view open_text) const
+{
+    return transposeUtf8(open_text, true);
+}
+std::string modAlphakey::decrypt(std::string_view cipher_text) const
+{
+    return transposeUtf8(cipher_text, false);
+}
+CipherStream<modAlphakey>::CipherStream(const modAlphakey& cipher, bool forward):
+    cipher(cipher), forward(forward)
+{
+}
+size_t CipherStream<modAlphakey>::update(const wchar_t* in, size_t length, wchar_t*)
+{
+    buffer.append(in, length);
+    return 0;
+}
+std::wstring CipherStream<modAlphakey>::update(const std::wstring& fragment)
+{
+    update(fragment.data(), fragment.size(), nullptr);
+    return wstring();
+}
+size_t CipherStream<modAlphakey>::finalize(wchar_t* out)
+{
+    size_t written = buffer.size();
+    cipher.transpose(buffer.data(), buffer.size(), out, forward);
+    buffer.clear();
+    return written;
+}
+std::wstring CipherStream<modAlphakey>::finalize()
+{
+    wstring result(buffer.size(), L'\0');
+    finalize(&result[0]);
+    return result;
+}
@@ -1,18 +1,62 @@
 #pragma once
+#include <algorithm>
 #include <cctype>
 #include <codecvt>
+#include <cstdint>
 #include <iostream>
 #include <locale>
 #include <map>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
+template <class Cipher> class CipherStream; // потоковый контекст шифра (фрагменты произвольной длины)
 class modAlphakey
 {
 private:
     int key1; // кол-во столбцов
+    static constexpr size_t routeLimit = 1 << 16; // до этой длины маршрут хранится как готовая перестановка
+    static constexpr size_t tileRows = 16;        // строк таблицы в одном блоке для длинных текстов
+    struct Route {                         // маршрут для заданных ширины таблицы и длины текста
+        int key1 = 0;
+        size_t length = SIZE_MAX;
+        std::vector<size_t> columnStart;   // начало каждого столбца в шифротексте
+        std::vector<size_t> route;         // route[x] - позиция в открытом тексте x-го символа шифротекста
+    };
+    static const Route& prepare(int key1, size_t length); // маршрут из кэша своего потока
+    template <class T> void transpose(const T* in, size_t length, T* out, bool forward) const;
+    static size_t countChars(std::string_view text, size_t& width); // проверка UTF-8; width - длина всех символов или 0
+    template <size_t width> void transposeChars(const char* in, size_t bytes, size_t length, char* out, bool forward) const;
+    std::string transposeUtf8(std::string_view text, bool forward) const; // перестановка символов UTF-8
+    friend class CipherStream<modAlphakey>; // раскладывает текст по key1 столбцам
 public:
     modAlphakey() = delete; // запрет конструктора без параметров
-    modAlphakey(const int& key):key1(key){};
-    std::wstring encrypt(const std::wstring& open_text);   // зашифрование
-    std::wstring decrypt(const std::wstring& cipher_text); // расшифрование
+    modAlphakey(const int& key);
+    int width() const { return key1; } // кол-во столбцов
+    std::wstring encrypt(const std::wstring& open_text) const;   // зашифрование
+    std::wstring decrypt(const std::wstring& cipher_text) const; // расшифрование
+    std::string encrypt(std::string_view open_text) const;   // зашифрование текста в UTF-8
+    std::string decrypt(std::string_view cipher_text) const; // расшифрование текста в UTF-8
+    void encrypt(const wchar_t* open_text, size_t length, wchar_t* out) const;   // зашифрование в буфер (не совпадает с open_text)
+    void decrypt(const wchar_t* cipher_text, size_t length, wchar_t* out) const; // расшифрование в буфер (не совпадает с cipher_text)
+};
+// Маршрутная перестановка не может выдать ни одного символа, пока не известна
+// длина всего текста: от неё зависят высоты столбцов. Поэтому update() только
+// дописывает фрагмент в один непрерывный буфер, а finalize() переставляет его
+// целиком тем же блочным transpose(), что и encrypt()/decrypt(). В памяти
+// не больше символов, чем уже подано, независимо от ширины таблицы.
+template <>
+class CipherStream<modAlphakey>
+{
+private:
+    modAlphakey cipher;
+    bool forward;                      // true - зашифрование, false - расшифрование
+    std::wstring buffer;               // поданный текст
+public:
+    CipherStream(const modAlphakey& cipher, bool forward);
+    size_t update(const wchar_t* in, size_t length, wchar_t* out); // накапливает фрагмент, возвращает 0 записанных символов
+    std::wstring update(const std::wstring& fragment);           // всегда пустая строка
+    size_t pending() const { return buffer.size(); }             // сколько символов запишет finalize()
+    size_t finalize(wchar_t* out);     // записывает pending() символов и готовит контекст к следующему тексту
+    std::wstring finalize();
 };
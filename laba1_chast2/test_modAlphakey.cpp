@@ -0,0 +1,185 @@
+#include <UnitTest++/UnitTest++.h>
+#include "modAlphakey.h"
+#include "widthSolver.h"
+#include <climits>
+#include <random>
+#include <thread>
+
+// Прежний обход таблицы по столбцам, эталон для сравнения
+std::wstring referenceEncrypt(const std::wstring& open_text, int key1)
+{
+    std::wstring tabl;
+    int dl = open_text.length();
+    int nstrok = (dl - 1) / key1 + 1;
+    for(int i = key1; i > 0; i--) {
+        for(int j = 0; j < nstrok; j++) {
+            int index = i + key1 * j;
+            if(index - 1 < dl) {
+                tabl += open_text[index - 1];
+            }
+        }
+    }
+    return tabl;
+}
+
+// Текст из случайных слов небольшого словаря: у пар соседних символов есть статистика
+std::wstring randomWords(size_t words, unsigned seed)
+{
+    const std::vector<std::wstring> vocabulary = {L"шифр", L"ключ", L"текст", L"таблица", L"столбец", L"строка",
+                                                  L"маршрут", L"перестановка", L"открытый", L"символ"};
+    std::mt19937 gen(seed);
+    std::wstring text;
+    for(size_t i = 0; i < words; i++) {
+        text += vocabulary[gen() % vocabulary.size()];
+        text += i % 12 == 11 ? L".\n" : L" ";
+    }
+    return text;
+}
+
+std::wstring randomText(size_t length, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::wstring text(length, L' ');
+    for(auto& c : text) {
+        c = L'А' + gen() % 32;
+    }
+    return text;
+}
+
+TEST(TestEncryptValidText) {
+    modAlphakey cipher(3);
+    CHECK(cipher.encrypt(std::wstring(L"ПРОГРАММИСТ")) == L"ОАИРРМТПГМС");
+    CHECK(cipher.decrypt(std::wstring(L"ОАИРРМТПГМС")) == L"ПРОГРАММИСТ");
+}
+
+TEST(TestEncryptUtf8) {
+    modAlphakey cipher(3);
+    CHECK_EQUAL(cipher.encrypt(std::string_view("ПРОГРАММИСТ")), std::string("ОАИРРМТПГМС"));
+    CHECK_EQUAL(cipher.decrypt(std::string_view("ОАИРРМТПГМС")), std::string("ПРОГРАММИСТ"));
+    CHECK_THROW(cipher.encrypt(std::string_view("П\xD0")), std::invalid_argument);
+    CHECK_THROW(cipher.encrypt(std::string_view("\xC0\xAF")), std::invalid_argument); // байт 0xC0 не начинает символ
+}
+
+TEST(TestUtf8MatchesWideText) {
+    // Символы разной длины и одинаковой (от одного до четырёх байт); длины по обе стороны
+    // от перехода к блочной перестановке; ключ шире текста
+    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+    std::mt19937 gen(10);
+    for(const std::wstring letters : {L"AЖ€\U0001F600", L"ABC", L"ПРОГ", L"€", L"\U0001F600"}) {
+        for(size_t length : {1, 7, 1000, 70001}) {
+            std::wstring text(length, L' ');
+            for(auto& c : text) {
+                c = letters[gen() % letters.size()];
+            }
+            const std::string bytes = converter.to_bytes(text);
+            for(int key : {1, 3, 64, 100000}) {
+                modAlphakey cipher(key);
+                const std::string encrypted = cipher.encrypt(std::string_view(bytes));
+                CHECK(encrypted == converter.to_bytes(cipher.encrypt(text)));
+                CHECK(cipher.decrypt(std::string_view(encrypted)) == bytes);
+            }
+        }
+    }
+}
+
+TEST(TestInvalidKey) {
+    CHECK_THROW(modAlphakey(0), std::invalid_argument);
+    CHECK_THROW(modAlphakey(-3), std::invalid_argument);
+}
+
+TEST(TestKeyWiderThanText) {
+    modAlphakey cipher(10);
+    CHECK(cipher.encrypt(std::wstring(L"АБВ")) == L"ВБА");
+    CHECK(cipher.decrypt(std::wstring(L"ВБА")) == L"АБВ");
+}
+
+TEST(TestLongTextMatchesReference) {
+    for(int key : {1, 7, 1000}) {
+        const std::wstring text = randomText(100003, key);
+        modAlphakey cipher(key);
+        const std::wstring encrypted = cipher.encrypt(text);
+        CHECK(encrypted == referenceEncrypt(text, key));
+        CHECK(cipher.decrypt(encrypted) == text);
+    }
+}
+
+TEST(TestCipherStreamMatchesWholeText) {
+    std::mt19937 gen(18);
+    for(int key : {1, 3, 7, 1000}) {
+        const std::wstring text = randomText(5003, key);
+        modAlphakey cipher(key);
+        const std::wstring expected = cipher.encrypt(text);
+        CipherStream<modAlphakey> encryptor(cipher, true);
+        CipherStream<modAlphakey> decryptor(cipher, false);
+        for(size_t pos = 0; pos < text.size();) {
+            const size_t n = std::min<size_t>(gen() % 40, text.size() - pos);
+            CHECK(encryptor.update(text.substr(pos, n)).empty());
+            decryptor.update(expected.substr(pos, n));
+            pos += n;
+        }
+        CHECK_EQUAL(encryptor.pending(), text.size());
+        CHECK(encryptor.finalize() == expected);
+        CHECK(decryptor.finalize() == text);
+        CHECK_EQUAL(encryptor.pending(), 0u);
+        encryptor.update(std::wstring(L"ПРОГРАММИСТ"));
+        CHECK(encryptor.finalize() == cipher.encrypt(std::wstring(L"ПРОГРАММИСТ")));
+    }
+}
+
+TEST(TestCipherStreamKeyWiderThanText) {
+    // Таблица шире текста: контекст не должен выделять память под каждый столбец.
+    const modAlphakey cipher(INT_MAX);
+    CipherStream<modAlphakey> encryptor(cipher, true);
+    encryptor.update(std::wstring(L"АБВ"));
+    encryptor.update(std::wstring(L"ГД"));
+    CHECK(encryptor.finalize() == L"ДГВБА");
+    CipherStream<modAlphakey> decryptor(cipher, false);
+    decryptor.update(std::wstring(L"ДГВБА"));
+    CHECK(decryptor.finalize() == L"АБВГД");
+}
+
+TEST(TestRankWidthsFindsKey) {
+    const BigramScorer model(randomWords(2000, 1));
+    const std::wstring encrypted = modAlphakey(13).encrypt(randomWords(3000, 2));
+    WidthOptions options;
+    options.maxWidth = 40;
+    options.threads = 3;
+    const std::vector<WidthScore> widths = rankWidths(std::wstring_view(encrypted), model, options);
+    CHECK_EQUAL(widths.size(), 40u);
+    CHECK_EQUAL(widths[0].key1, 13);
+    CHECK(widths[0].score > widths[1].score + 0.5);
+    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+    CHECK_EQUAL(rankWidths(std::string_view(converter.to_bytes(encrypted)), model, options)[0].key1, 13);
+    CHECK_EQUAL(rankWidths(std::wstring_view(L"АБВ"), model, options).size(), 3u);
+    CHECK_THROW(rankWidths(std::wstring_view(), model, options), std::invalid_argument);
+}
+
+TEST(TestSharedInstanceConcurrentUse) {
+    const modAlphakey cipher(7);
+    std::vector<std::wstring> texts;
+    std::vector<std::wstring> expected;
+    for(size_t length : {5, 100, 4096, 70000}) {
+        texts.push_back(randomText(length, length));
+        expected.push_back(referenceEncrypt(texts.back(), 7));
+    }
+    std::vector<int> failures(8, 0);
+    std::vector<std::thread> workers;
+    for(int t = 0; t < 8; t++) {
+        workers.emplace_back([&, t] {
+            for(int i = 0; i < 50; i++) {
+                const size_t m = (t + i) % texts.size();
+                const std::wstring encrypted = cipher.encrypt(texts[m]);
+                failures[t] += encrypted != expected[m];
+                failures[t] += cipher.decrypt(encrypted) != texts[m];
+            }
+        });
+    }
+    for(auto& worker : workers) {
+        worker.join();
+    }
+    CHECK(failures == std::vector<int>(8, 0));
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,142 @@
+#include "widthSolver.h"
+#include "../common/utf8.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+using namespace std;
+BigramScorer::BigramScorer(std::wstring_view sample):table(classCount * classCount)
+{
+    if(sample.size() < 2) {
+        throw invalid_argument("Sample text is too short");
+    }
+    vector<double> counts(classCount * classCount, 0.5); // невстреченная пара не даёт -inf
+    for(size_t i = 1; i < sample.size(); i++) {
+        counts[classOf(sample[i - 1]) * classCount + classOf(sample[i])] += 1;
+    }
+    double total = sample.size() - 1 + 0.5 * counts.size();
+    for(size_t i = 0; i < counts.size(); i++) {
+        table[i] = static_cast<float>(log(counts[i] / total));
+    }
+}
+unsigned char BigramScorer::classOf(wchar_t c)
+{
+    if(c >= L'a' && c <= L'z') {
+        return 4 + (c - L'a');
+    }
+    if(c >= L'A' && c <= L'Z') {
+        return 4 + (c - L'A');
+    }
+    if(c == L'ё' || c == L'Ё') {
+        return 30 + 6; // Ё стоит после Е
+    }
+    if(c >= L'а' && c <= L'я') {
+        c -= L'а' - L'А';
+    }
+    if(c >= L'А' && c <= L'Я') {
+        return 30 + (c - L'А') + (c >= L'Ж' ? 1 : 0);
+    }
+    if(c == L' ' || c == L'\n' || c == L'\t' || c == L'\r') {
+        return 1;
+    }
+    if(c >= L'0' && c <= L'9') {
+        return 2;
+    }
+    if(c > L' ' && c < 0x7F) {
+        return 3; // прочие печатные символы ASCII - знаки препинания
+    }
+    return 0;
+}
+namespace {
+// Оценка одной ширины. Для ширины w символ строки r столбца c стоит в шифротексте
+// на месте start[c] + r, его сосед справа - на месте start[c + 1] + r, а сосед
+// последнего столбца - первый символ следующей строки, start[0] + r + 1.
+double widthScore(const unsigned char* text, size_t length, size_t width, size_t rows, const BigramScorer& model)
+{
+    vector<size_t> start(width), height(width);
+    size_t x = 0;
+    for(size_t c = width; c-- > 0;) { // столбцы справа налево, как в modAlphakey
+        height[c] = c < length ? (length - c + width - 1) / width : 0;
+        start[c] = x;
+        x += height[c];
+    }
+    double total = 0;
+    size_t pairs = 0;
+    auto add = [&](const unsigned char* a, const unsigned char* b, size_t count) {
+        for(size_t r0 = 0; r0 < count; r0 += 4096) { // float внутри блока, double между блоками
+            float sum = 0;
+            for(size_t r = r0; r < min(count, r0 + 4096); r++) {
+                sum += model.score(a[r], b[r]);
+            }
+            total += sum;
+        }
+        pairs += count;
+    };
+    for(size_t c = 0; c + 1 < width; c++) {
+        add(text + start[c], text + start[c + 1], min(height[c + 1], rows));
+    }
+    if(height[0] > 1) {
+        add(text + start[width - 1], text + start[0] + 1, min({height[width - 1], height[0] - 1, rows}));
+    }
+    return pairs ? total / pairs : 0;
+}
+vector<WidthScore> rankClasses(const vector<unsigned char>& text, const BigramScorer& model,
+                               const WidthOptions& options)
+{
+    if(text.empty()) {
+        throw invalid_argument("Empty text");
+    }
+    if(options.maxWidth <= 0) {
+        throw invalid_argument("Key must be positive");
+    }
+    // Все ширины не меньше длины текста дают одну и ту же перестановку (обращение текста)
+    size_t widths = min<size_t>(options.maxWidth, text.size());
+    size_t rows = options.sampleRows ? options.sampleRows : SIZE_MAX;
+    vector<WidthScore> result(widths);
+    unsigned threads = options.threads ? options.threads : max(1u, thread::hardware_concurrency());
+    threads = min<size_t>(threads, widths);
+    atomic<size_t> next{0}; // ширины раздаются по одной: широкие таблицы оцениваются дольше
+    auto work = [&] {
+        for(size_t i; (i = next.fetch_add(1)) < widths;) {
+            result[i] = WidthScore{int(i + 1), widthScore(text.data(), text.size(), i + 1, rows, model)};
+        }
+    };
+    vector<thread> workers;
+    for(unsigned t = 1; t < threads; t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for(auto& worker : workers) {
+        worker.join();
+    }
+    stable_sort(result.begin(), result.end(), [](const WidthScore& a, const WidthScore& b) {
+        return a.score > b.score;
+    });
+    return result;
+}
+} // namespace
+std::vector<WidthScore> rankWidths(std::wstring_view cipher_text, const BigramScorer& model,
+                                   const WidthOptions& options)
+{
+    vector<unsigned char> text(cipher_text.size());
+    transform(cipher_text.begin(), cipher_text.end(), text.begin(), BigramScorer::classOf);
+    return rankClasses(text, model, options);
+}
+std::vector<WidthScore> rankWidths(std::string_view cipher_text, const BigramScorer& model,
+                                   const WidthOptions& options)
+{
+    vector<unsigned char> text;
+    text.reserve(cipher_text.size());
+    for(size_t pos = 0; pos < cipher_text.size();) {
+        uint32_t code;
+        size_t len = decodeUtf8Char(cipher_text.data() + pos, cipher_text.size() - pos, code);
+        if(len == 0) {
+            throw invalid_argument("Invalid UTF-8 text");
+        }
+        text.push_back(BigramScorer::classOf(static_cast<wchar_t>(code)));
+        pos += len;
+    }
+    return rankClasses(text, model, options);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+// Подбор ширины таблицы (key1) маршрутной перестановки по шифротексту.
+// Перестановка не меняет символов, поэтому ширины сравниваются по парам соседних
+// символов открытого текста: для ширины w соседи по строке таблицы лежат в соседних
+// столбцах, то есть в шифротексте - в двух непрерывных отрезках. Пары читаются прямо
+// из шифротекста двумя последовательными проходами, открытый текст не строится.
+class BigramScorer   // логарифмы вероятностей пар классов символов, обученные на образце текста
+{
+public:
+    static constexpr size_t classCount = 64; // прочие, пробелы, цифры, знаки, 26 латинских и 33 русские буквы
+    explicit BigramScorer(std::wstring_view sample); // образец текста на языке открытого текста
+    static unsigned char classOf(wchar_t c);          // класс символа (регистр букв не различается)
+    float score(unsigned char first, unsigned char second) const { return table[first * classCount + second]; }
+private:
+    std::vector<float> table; // table[first * classCount + second]
+};
+struct WidthScore
+{
+    int key1;     // ширина таблицы
+    double score; // средний логарифм вероятности пары соседних символов
+};
+struct WidthOptions
+{
+    int maxWidth = 64;        // проверяются ширины 1..maxWidth
+    size_t sampleRows = 4096; // сколько первых строк таблицы оценивать (0 - все)
+    unsigned threads = 0;     // число потоков (0 - по числу ядер)
+};
+// Ширины по убыванию оценки; исключение invalid_argument, если текст пуст или maxWidth <= 0
+std::vector<WidthScore> rankWidths(std::wstring_view cipher_text, const BigramScorer& model,
+                                   const WidthOptions& options = WidthOptions());
+std::vector<WidthScore> rankWidths(std::string_view cipher_text, const BigramScorer& model,
+                                   const WidthOptions& options = WidthOptions()); // текст в UTF-8
@@ -1,15 +1,11 @@
 #include "modGronsfeld.h"
+#include "../common/textValidator.h"
 #include <iostream>
 #include <locale>
 
 bool isValid(const std::wstring& s) {
-    for (auto c : s) {
-        // Проверяем, является ли символ заглавной буквой русского алфавита
-        if (!iswupper(c) && c != L'Ё') { // Не забываем про букву Ё
-            return false;
-        }
-    }
-    return true;
+    // Только заглавные буквы русского алфавита, включая Ё
+    return isValidText(s, cyrillicUpper);
 }
 
 int main() {
@@ -1,4 +1,5 @@
 #include "modPermutation.h"
+#include "../common/textValidator.h"
 #include <stdexcept>
 #include <locale>
 
@@ -34,10 +35,10 @@ void modPermutationCipher::validateText(const std::wstring& text) {
     if (text.empty()) {
         throw std::invalid_argument("Ошибка: текст не может быть пустым. Пожалуйста, введите текст для шифрования/расшифрования.");
     }
-    for (const auto& ch : text) {
-        if (alphabet.find(ch) == std::wstring::npos) {
-            throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита (русские и английские буквы).");
-        }
+    // Алфавит: А-Я, Ё и строчные латинские a-z
+    const std::array<CodeRange, 3> ranges = {{{L'a', L'z'}, {L'Ё', L'Ё'}, {L'А', L'Я'}}};
+    if (!isValidText(text, ranges)) {
+        throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита (русские и английские буквы).");
     }
 }
 
@@ -43,16 +43,13 @@ std::wstring modAlphaCipher::encrypt(const std::wstring& open_text) {
         throw std::invalid_argument("Text cannot be empty");
     }
 
-    try {
-        std::vector<int> work = convert(open_text);
-        for (unsigned i = 0; i < work.size(); i++) {
-            work[i] = (work[i] + key[i % key.size()]) % numAlpha.size();
-        }
-        return convert(work);
-    } catch (const std::exception& e) {
-        std::wcerr << L"Encryption error: " << e.what() << std::endl;
-        throw;
+    // Ошибка преобразования передаётся вызывающему как есть: сообщение
+    // печатает тот, кто её обработал, а не каждый уровень по пути.
+    std::vector<int> work = convert(open_text);
+    for (unsigned i = 0; i < work.size(); i++) {
+        work[i] = (work[i] + key[i % key.size()]) % numAlpha.size();
     }
+    return convert(work);
 }
 
 // Расшифрование текста
@@ -61,15 +58,10 @@ std::wstring modAlphaCipher::decrypt(const std::wstring& cipher_text) {
         throw std::invalid_argument("Text cannot be empty");
     }
 
-    try {
-        std::vector<int> work = convert(cipher_text);
-        for (unsigned i = 0; i < work.size(); i++) {
-            work[i] = (work[i] + numAlpha.size() - key[i % key.size()]) % numAlpha.size();
-        }
-        return convert(work);
-    } catch (const std::exception& e) {
-        std::wcerr << L"Decryption error: " << e.what() << std::endl;
-        throw;
+    std::vector<int> work = convert(cipher_text);
+    for (unsigned i = 0; i < work.size(); i++) {
+        work[i] = (work[i] + numAlpha.size() - key[i % key.size()]) % numAlpha.size();
     }
+    return convert(work);
 }
 
@@ -1,4 +1,5 @@
 #include "modPermutation.h"
+#include "../common/textValidator.h"
 #include <stdexcept>
 #include <locale>
 
@@ -34,10 +35,8 @@ void modPermutationCipher::validateText(const std::wstring& text) {
     if (text.empty()) {
         throw std::invalid_argument("Ошибка: текст не может быть пустым. Пожалуйста, введите текст для шифрования/расшифрования.");
     }
-    for (const auto& ch : text) {
-        if (alphabet.find(ch) == std::wstring::npos) {
-            throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита (русские и английские буквы).");
-        }
+    if (!isValidText(text, cyrillicLatinUpper)) { // алфавит: А-Я, Ё, A-Z
+        throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита (русские и английские буквы).");
     }
 }
 
@@ -0,0 +1,257 @@
+/**
+ * @file alphabet.h
+ * @brief Алфавиты шифра Гронсвельда, заданные на этапе компиляции, и общий вид таблиц алфавита.
+ *
+ * @details
+ * Алфавит — тип с полем `letters`. По нему `AlphabetTables` строит на этапе
+ * компиляции таблицу "код символа → номер в алфавите" и представление букв
+ * в UTF-8, а размер алфавита становится константой, известной компилятору.
+ * Там же алфавит раскладывается на отрезки подряд идущих кодов, по которым
+ * текст проверяется общей векторной проверкой (common/textValidator.h).
+ *
+ * Буквы берутся из общих определений в common/textValidator.h — тех же, из которых
+ * собраны готовые алфавиты Alphabet (common/runtimeAlphabet.h). Для готовых алфавитов
+ * шифр Гронсвельда остаётся шаблоном над алфавитом времени компиляции, чтобы таблицы
+ * и модуль были константами. Алфавит, загруженный во время работы (`--alphabet`),
+ * шифр получает как объект Alphabet — общий для всех шифров. Горячие циклы шифра
+ * написаны один раз над видом таблиц: FixedLetters для алфавита времени компиляции
+ * и LoadedLetters для объекта Alphabet.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include "../common/runtimeAlphabet.h"
+#include "../common/textValidator.h"
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @brief Русский алфавит (33 буквы, включая 'Ё').
+ */
+struct RussianAlphabet {
+    static constexpr std::wstring_view letters = RUSSIAN_UPPER_LETTERS;
+};
+
+/**
+ * @brief Латинский алфавит (26 букв).
+ */
+struct LatinAlphabet {
+    static constexpr std::wstring_view letters = LATIN_UPPER_LETTERS;
+};
+
+/**
+ * @brief Русский и латинский алфавиты подряд (59 букв), как в шифре modPermutationCipher.
+ */
+struct CombinedAlphabet {
+    static constexpr std::wstring_view letters = RUSSIAN_UPPER_LETTERS LATIN_UPPER_LETTERS;
+};
+
+/**
+ * @brief Таблицы алфавита, построенные на этапе компиляции.
+ *
+ * @tparam Alphabet Тип с полем `static constexpr std::wstring_view letters`.
+ */
+template <class Alphabet>
+struct AlphabetTables {
+    static constexpr std::wstring_view letters = Alphabet::letters; /**< Буквы алфавита. */
+    static constexpr size_t size = letters.size();                  /**< Размер алфавита (модуль сдвига). */
+    static constexpr unsigned char invalidIndex = 0xFF;             /**< Метка символа, не входящего в алфавит. */
+
+    static_assert(size > 0 && size < invalidIndex, "alphabet must have 1..254 letters");
+
+    /**
+     * @brief Наименьший код буквы алфавита.
+     */
+    static constexpr wchar_t firstLetter() {
+        wchar_t first = letters[0];
+        for (wchar_t c : letters) {
+            first = c < first ? c : first;
+        }
+        return first;
+    }
+
+    /**
+     * @brief Наибольший код буквы алфавита.
+     */
+    static constexpr wchar_t lastLetter() {
+        wchar_t last = letters[0];
+        for (wchar_t c : letters) {
+            last = c > last ? c : last;
+        }
+        return last;
+    }
+
+    static constexpr wchar_t tableBase = firstLetter(); /**< Первый код таблицы индексов. */
+    static constexpr size_t tableSize = lastLetter() - tableBase + 1; /**< Размер таблицы индексов. */
+
+    /**
+     * @brief Длина буквы в UTF-8: 1 или 2 байта, 0 — если длина у букв разная.
+     */
+    static constexpr size_t utf8Width() {
+        return lastLetter() < 0x80 ? 1 : firstLetter() >= 0x80 && lastLetter() < 0x800 ? 2 : 0;
+    }
+
+    /**
+     * @brief Строит таблицу "код символа → номер в алфавите".
+     */
+    static constexpr std::array<unsigned char, tableSize> makeIndex() {
+        std::array<unsigned char, tableSize> table{};
+        for (size_t i = 0; i < tableSize; i++) {
+            table[i] = invalidIndex;
+        }
+        for (size_t i = 0; i < size; i++) {
+            table[letters[i] - tableBase] = static_cast<unsigned char>(i);
+        }
+        return table;
+    }
+
+    /**
+     * @brief Строит буквы в UTF-8, по два байта на букву (у однобайтовых второй байт не используется).
+     */
+    static constexpr std::array<char, 2 * size> makeUtf8() {
+        std::array<char, 2 * size> bytes{};
+        for (size_t i = 0; i < size; i++) {
+            const wchar_t c = letters[i];
+            if (c < 0x80) {
+                bytes[2 * i] = static_cast<char>(c);
+            } else {
+                bytes[2 * i] = static_cast<char>(0xC0 | (c >> 6));
+                bytes[2 * i + 1] = static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+        return bytes;
+    }
+
+    static constexpr std::array<unsigned char, tableSize> index = makeIndex(); /**< Номер буквы по коду. */
+    static constexpr std::array<char, 2 * size> utf8 = makeUtf8();             /**< Буквы в UTF-8. */
+
+    /**
+     * @brief Считает отрезки подряд идущих кодов, из которых состоит алфавит.
+     */
+    static constexpr size_t countRanges() {
+        size_t count = 0;
+        for (size_t i = 0; i < tableSize; i++) {
+            count += index[i] != invalidIndex && (i == 0 || index[i - 1] == invalidIndex);
+        }
+        return count;
+    }
+
+    static constexpr size_t rangeCount = countRanges(); /**< Число отрезков (русский — 2: 'Ё' и 'А'…'Я'). */
+
+    /**
+     * @brief Строит отрезки кодов алфавита в порядке возрастания.
+     */
+    static constexpr std::array<CodeRange, rangeCount> makeRanges() {
+        std::array<CodeRange, rangeCount> result{};
+        size_t count = 0;
+        for (size_t i = 0; i < tableSize; i++) {
+            if (index[i] == invalidIndex) {
+                continue;
+            }
+            const wchar_t code = static_cast<wchar_t>(tableBase + i);
+            if (i == 0 || index[i - 1] == invalidIndex) {
+                result[count++] = CodeRange{code, code};
+            } else {
+                result[count - 1].last = code;
+            }
+        }
+        return result;
+    }
+
+    static constexpr std::array<CodeRange, rangeCount> ranges = makeRanges(); /**< Отрезки кодов алфавита. */
+};
+
+/**
+ * @brief Совпадают ли наборы отрезков кодов.
+ */
+template <size_t N, size_t M>
+constexpr bool sameRanges(const std::array<CodeRange, N>& a, const std::array<CodeRange, M>& b) {
+    if (N != M) {
+        return false;
+    }
+    for (size_t i = 0; i < N; i++) {
+        if (a[i].first != b[i].first || a[i].last != b[i].last) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sameRanges(AlphabetTables<RussianAlphabet>::ranges, cyrillicUpper),
+              "cyrillicUpper must match RUSSIAN_UPPER_LETTERS");
+static_assert(sameRanges(AlphabetTables<LatinAlphabet>::ranges, latinUpper),
+              "latinUpper must match LATIN_UPPER_LETTERS");
+static_assert(sameRanges(AlphabetTables<CombinedAlphabet>::ranges, cyrillicLatinUpper),
+              "cyrillicLatinUpper must match both letter sets");
+
+/**
+ * @brief Таблицы алфавита времени компиляции в виде, общем с LoadedLetters.
+ *
+ * @details Все функции читают константы AlphabetTables, поэтому объект пуст,
+ * а размер алфавита и длина буквы в UTF-8 известны компилятору.
+ *
+ * @tparam Alphabet Тип с полем `static constexpr std::wstring_view letters`.
+ */
+template <class Alphabet>
+struct FixedLetters {
+    using Tables = AlphabetTables<Alphabet>;            /**< Таблицы алфавита. */
+    static constexpr int invalidIndex = Tables::invalidIndex; /**< Результат indexOf() для символа не из алфавита. */
+    static constexpr size_t utf8Stride = 2;             /**< Шаг букв в таблице utf8(). */
+
+    /**
+     * @brief Таблица номеров для горячего цикла (символ должен быть проверен findInvalid()).
+     */
+    struct Lookup {
+        unsigned char operator()(wchar_t c) const noexcept { return Tables::index[c - Tables::tableBase]; }
+    };
+
+    static constexpr size_t size() { return Tables::size; }
+    static constexpr size_t utf8Width() { return Tables::utf8Width(); }
+    static constexpr Lookup lookup() { return Lookup{}; }
+    static const wchar_t* symbols() { return Tables::letters.data(); }
+    static const char* utf8() { return Tables::utf8.data(); }
+
+    /**
+     * @brief Номер любого символа или invalidIndex.
+     */
+    static int indexOf(wchar_t c) {
+        const unsigned long offset = static_cast<unsigned long>(c) - Tables::tableBase;
+        return offset < Tables::tableSize ? Tables::index[offset] : invalidIndex;
+    }
+
+    /**
+     * @brief Первый символ не из алфавита или `length`.
+     */
+    static size_t findInvalid(const wchar_t* text, size_t length) noexcept {
+        return findOutside(text, length, Tables::ranges.data(), Tables::ranges.size());
+    }
+};
+
+/**
+ * @brief Таблицы алфавита, заданного во время работы, в виде, общем с FixedLetters.
+ *
+ * @details Вид таблицы номеров (`Lookup` — Alphabet::DenseLookup или Alphabet::PagedLookup)
+ * выбирается один раз на вызов шифра (см. Alphabet::withLookup()). Буквы в UTF-8
+ * и их общая длина вычисляются шифром при разборе ключа и хранятся вместе с ним.
+ */
+template <class Lookup>
+struct LoadedLetters {
+    static constexpr int invalidIndex = Alphabet::invalidIndex; /**< Результат indexOf() для символа не из алфавита. */
+    static constexpr size_t utf8Stride = 4;                     /**< Шаг букв в таблице utf8(). */
+
+    const Alphabet& alphabet; /**< Алфавит. */
+    Lookup table;             /**< Таблица номеров. */
+    const char* bytes;        /**< Буквы в UTF-8 по utf8Stride байт. */
+    size_t width;             /**< Длина буквы в UTF-8 или 0, если у букв она разная. */
+
+    size_t size() const noexcept { return alphabet.size(); }
+    size_t utf8Width() const noexcept { return width; }
+    Lookup lookup() const noexcept { return table; }
+    const wchar_t* symbols() const noexcept { return alphabet.letters().data(); }
+    const char* utf8() const noexcept { return bytes; }
+    int indexOf(wchar_t c) const noexcept { return alphabet.indexOf(c); }
+    size_t findInvalid(const wchar_t* text, size_t length) const noexcept { return alphabet.findInvalid(text, length); }
+};
@@ -0,0 +1,381 @@
+/**
+ * @file bench_modGronsfeld.cpp
+ * @brief Замер пропускной способности шифра Гронсвельда.
+ *
+ * Сравнивает текущую реализацию `modAlphaCipher` (плотная таблица индексов)
+ * с прежним вариантом на `std::map<wchar_t, int>`, а также шифрование
+ * в заранее выделенный буфер без выделения памяти на каждое сообщение.
+ * Отдельно замеряется ядро сдвига индексов для каждой реализации (scalar/SSE4.2/AVX2)
+ * и шифрование текста в UTF-8: через `wstring_convert` и std::wstring против
+ * перегрузки `encrypt(std::string_view)`. Для коротких сообщений сравнивается
+ * вызов `encrypt` в цикле с пакетным `encryptBatch` (в сообщениях в секунду),
+ * а также стоимость создания объекта шифра для повторяющегося ключа (из кэша
+ * расписаний) и для каждый раз нового ключа. Для потока сообщений с недопустимым
+ * символом сравнивается отказ через исключение (`encrypt`) и через код результата
+ * (`tryEncrypt`), а ядро проверки символов замеряется для каждой реализации.
+ *
+ * @details
+ * Пропускная способность считается в МБ/с по объёму текста в UTF-8
+ * (каждая буква русского алфавита занимает 2 байта).
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "modGronsfeld.h"
+#include "shiftKernel.h"
+#include <chrono>
+#include <codecvt>
+#include <cstdio>
+#include <map>
+#include <locale>
+#include <random>
+
+namespace {
+
+volatile wchar_t sink; /**< Не даёт компилятору выбросить результат шифрования. */
+
+/**
+ * @brief Прежняя реализация шифра на `std::map`, оставленная как эталон для сравнения.
+ */
+class mapAlphaCipher {
+private:
+    std::wstring numAlpha = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::map<wchar_t, int> alphaNum;
+    std::vector<int> key;
+
+    std::vector<int> convert(const std::wstring& s) {
+        std::vector<int> result;
+        for (auto c : s) {
+            if (alphaNum.find(c) == alphaNum.end()) {
+                throw std::invalid_argument("Invalid character in input.");
+            }
+            result.push_back(alphaNum[c]);
+        }
+        return result;
+    }
+
+    std::wstring convert(const std::vector<int>& v) {
+        std::wstring result;
+        for (auto i : v) {
+            result += numAlpha[i];
+        }
+        return result;
+    }
+
+public:
+    explicit mapAlphaCipher(const std::wstring& skey) {
+        for (size_t i = 0; i < numAlpha.size(); i++) {
+            alphaNum[numAlpha[i]] = i;
+        }
+        key = convert(skey);
+    }
+
+    std::wstring encrypt(const std::wstring& open_text) {
+        std::vector<int> work = convert(open_text);
+        for (size_t i = 0; i < work.size(); i++) {
+            work[i] = (work[i] + key[i % key.size()]) % numAlpha.size();
+        }
+        return convert(work);
+    }
+};
+
+/**
+ * @brief Генерирует случайный текст из букв русского алфавита.
+ */
+std::wstring randomText(size_t length) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> dist(0, alphabet.size() - 1);
+    std::wstring text(length, L' ');
+    for (auto& c : text) {
+        c = alphabet[dist(gen)];
+    }
+    return text;
+}
+
+/**
+ * @brief Выполняет шифрование несколько раз и возвращает лучший результат в МБ/с.
+ */
+template <class Cipher>
+double measure(Cipher& cipher, const std::wstring& text, int repeats) {
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        std::wstring result = cipher.encrypt(text);
+        auto stop = std::chrono::steady_clock::now();
+        sink = result[r % result.size()];
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        double mbps = text.size() * 2 / seconds / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief То же, что measure(), но через перегрузку с буфером вызывающей стороны.
+ */
+double measureBuffer(const modAlphaCipher& cipher, const std::wstring& text, int repeats) {
+    double best = 0;
+    std::wstring result(text.size(), L'\0');
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        cipher.encrypt(text.data(), text.size(), &result[0]);
+        auto stop = std::chrono::steady_clock::now();
+        sink = result[r % result.size()];
+        double seconds = std::chrono::duration<double>(stop - start).count();
+        double mbps = text.size() * 2 / seconds / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Замеряет ядро сдвига индексов в МБ/с (по одному байту на символ).
+ */
+double measureKernel(ShiftKernel kernel, size_t length, int repeats) {
+    std::mt19937 gen(7);
+    std::vector<unsigned char> text(length), stream(length), out(length);
+    for (size_t i = 0; i < length; i++) {
+        text[i] = static_cast<unsigned char>(gen() % 33);
+        stream[i] = static_cast<unsigned char>(gen() % 33);
+    }
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        shiftIndices(kernel, text.data(), stream.data(), length, 33, out.data());
+        auto stop = std::chrono::steady_clock::now();
+        sink = out[r % length];
+        double mbps = length / std::chrono::duration<double>(stop - start).count() / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Замеряет шифрование текста в UTF-8 в МБ/с.
+ *
+ * @param viaWide true — через перевод в std::wstring и обратно, false — через encrypt(std::string_view).
+ */
+double measureUtf8(modAlphaCipher& cipher, const std::string& text, bool viaWide, int repeats) {
+    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        std::string result = viaWide ? converter.to_bytes(cipher.encrypt(converter.from_bytes(text)))
+                                     : cipher.encrypt(std::string_view(text));
+        auto stop = std::chrono::steady_clock::now();
+        sink = result[r % result.size()];
+        double mbps = text.size() / std::chrono::duration<double>(stop - start).count() / 1e6;
+        if (mbps > best) {
+            best = mbps;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Замеряет шифрование пакета коротких сообщений в сообщениях в секунду.
+ *
+ * @param mode 0 — encrypt(std::wstring) в цикле, 1 — encrypt в буфер в цикле, 2 — encryptBatch.
+ */
+double measureMessages(const modAlphaCipher& cipher, const MessageBatch& batch,
+                       const std::vector<std::wstring>& messages, int mode, int repeats) {
+    modAlphaCipher copy = cipher;
+    std::wstring out(batch.text.size(), L'\0');
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        if (mode == 0) {
+            for (const auto& message : messages) {
+                sink = copy.encrypt(message)[0];
+            }
+        } else if (mode == 1) {
+            for (size_t m = 0; m < messages.size(); m++) {
+                cipher.encrypt(batch.text.data() + batch.offsets[m], messages[m].size(), &out[batch.offsets[m]]);
+            }
+        } else {
+            cipher.encryptBatch(batch.text.data(), batch.offsets.data(), messages.size(), &out[0]);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        sink = out[r % out.size()];
+        double rate = messages.size() / std::chrono::duration<double>(stop - start).count();
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Замеряет создание объекта шифра в тысячах объектов в секунду.
+ *
+ * @param keys Ключи, по которым по очереди создаются объекты.
+ */
+double measureConstruction(const std::vector<std::wstring>& keys, int repeats) {
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& key : keys) {
+            modAlphaCipher cipher(key);
+            sink = cipher.encrypt(key)[0];
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double rate = keys.size() / std::chrono::duration<double>(stop - start).count() / 1e3;
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Замеряет отказ на сообщениях с недопустимым символом в сообщениях в секунду.
+ *
+ * @param useTry true — tryEncrypt, false — encrypt с перехватом исключения.
+ */
+double measureRejects(const modAlphaCipher& cipher, const MessageBatch& batch, size_t count, bool useTry,
+                      int repeats) {
+    std::wstring out(batch.text.size(), L'\0');
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        size_t rejected = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t m = 0; m < count; m++) {
+            const wchar_t* text = batch.text.data() + batch.offsets[m];
+            const size_t length = batch.offsets[m + 1] - batch.offsets[m];
+            if (useTry) {
+                rejected += !cipher.tryEncrypt(text, length, &out[batch.offsets[m]]);
+            } else {
+                try {
+                    cipher.encrypt(text, length, &out[batch.offsets[m]]);
+                } catch (const std::invalid_argument&) {
+                    rejected++;
+                }
+            }
+        }
+        auto stop = std::chrono::steady_clock::now();
+        sink = static_cast<wchar_t>(rejected);
+        double rate = count / std::chrono::duration<double>(stop - start).count();
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Замеряет ядро проверки символов заданной реализации в МБ/с (по 4 байта на символ).
+ */
+double measureFind(ValidatorKernel kernel, size_t length, int repeats) {
+    using Tables = AlphabetTables<RussianAlphabet>;
+    const std::wstring text = randomText(length);
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        sink = static_cast<wchar_t>(findOutside(kernel, text.data(), text.size(), Tables::ranges.data(),
+                                                Tables::rangeCount));
+        auto stop = std::chrono::steady_clock::now();
+        double speed = length * sizeof(wchar_t) / std::chrono::duration<double>(stop - start).count() / 1e6;
+        if (speed > best) {
+            best = speed;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    const std::wstring key = L"БКДЯЁ";
+    modAlphaCipher tableCipher(key);
+    mapAlphaCipher mapCipher(key);
+
+    std::printf("%12s %14s %14s %15s %8s\n", "size, chars", "map, MB/s", "table, MB/s", "buffer, MB/s", "gain");
+    for (size_t length : {1u << 10, 1u << 16, 1u << 20, 1u << 23}) {
+        std::wstring text = randomText(length);
+        if (tableCipher.encrypt(text) != mapCipher.encrypt(text)) {
+            std::fprintf(stderr, "results differ for %zu chars\n", length);
+            return 1;
+        }
+        int repeats = length < (1u << 20) ? 50 : 5;
+        double mapSpeed = measure(mapCipher, text, repeats);
+        double tableSpeed = measure(tableCipher, text, repeats);
+        double bufferSpeed = measureBuffer(tableCipher, text, repeats);
+        std::printf("%12zu %14.1f %14.1f %15.1f %7.2fx\n", length, mapSpeed, tableSpeed, bufferSpeed,
+                    tableSpeed / mapSpeed);
+    }
+
+    std::printf("\n%12s %14s %14s %8s\n", "size, chars", "wstring, MB/s", "utf-8, MB/s", "gain");
+    for (size_t length : {1u << 6, 1u << 10, 1u << 16, 1u << 20}) {
+        std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+        const std::string text = converter.to_bytes(randomText(length));
+        int repeats = length < (1u << 16) ? 2000 : 20;
+        double wideSpeed = measureUtf8(tableCipher, text, true, repeats);
+        double utf8Speed = measureUtf8(tableCipher, text, false, repeats);
+        std::printf("%12zu %14.1f %14.1f %7.2fx\n", length, wideSpeed, utf8Speed, utf8Speed / wideSpeed);
+    }
+
+    {
+        std::mt19937 gen(11);
+        const std::wstring pool = randomText(200);
+        MessageBatch batch;
+        std::vector<std::wstring> messages;
+        batch.offsets.push_back(0);
+        for (int m = 0; m < 100000; m++) {
+            messages.push_back(pool.substr(0, 10 + gen() % 191));
+            batch.text += messages.back();
+            batch.offsets.push_back(batch.text.size());
+        }
+        std::printf("\n100000 messages of 10-200 chars, Mmsg/s:\n");
+        std::printf("%24s %10.2f\n", "encrypt(wstring) loop", measureMessages(tableCipher, batch, messages, 0, 10) / 1e6);
+        std::printf("%24s %10.2f\n", "encrypt(buffer) loop", measureMessages(tableCipher, batch, messages, 1, 10) / 1e6);
+        std::printf("%24s %10.2f\n", "encryptBatch", measureMessages(tableCipher, batch, messages, 2, 10) / 1e6);
+
+        MessageBatch invalid = batch;
+        for (size_t m = 0; m < messages.size(); m++) {
+            invalid.text[invalid.offsets[m] + gen() % messages[m].size()] = L'#';
+        }
+        std::printf("\n100000 messages with an invalid character, Mmsg/s:\n");
+        std::printf("%24s %10.2f\n", "encrypt + catch", measureRejects(tableCipher, invalid, messages.size(), false, 5) / 1e6);
+        std::printf("%24s %10.2f\n", "tryEncrypt", measureRejects(tableCipher, invalid, messages.size(), true, 5) / 1e6);
+    }
+
+    {
+        std::mt19937 gen(13);
+        const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+        std::vector<std::wstring> distinct(100000);
+        for (auto& k : distinct) {
+            k.resize(16);
+            for (auto& c : k) {
+                c = alphabet[gen() % alphabet.size()];
+            }
+        }
+        std::vector<std::wstring> repeated(distinct.size(), distinct[0]);
+        std::printf("\ncipher construction + encrypt(key), 16-letter keys, K obj/s:\n");
+        std::printf("%24s %10.1f\n", "repeated key (cached)", measureConstruction(repeated, 5));
+        std::printf("%24s %10.1f\n", "new key every time", measureConstruction(distinct, 5));
+    }
+
+    const ShiftKernel detected = detectShiftKernel();
+    std::printf("\nshift kernel (detected: %s), 64K indices:\n", shiftKernelName(detected));
+    for (ShiftKernel kernel : {ShiftKernel::scalar, ShiftKernel::sse42, ShiftKernel::avx2}) {
+        if (static_cast<int>(kernel) <= static_cast<int>(detected)) {
+            std::printf("%12s %14.1f MB/s\n", shiftKernelName(kernel), measureKernel(kernel, 1u << 16, 200));
+        }
+    }
+    const ValidatorKernel validator = detectValidatorKernel();
+    std::printf("\nvalidation kernel (detected: %s), 16K characters:\n", validatorKernelName(validator));
+    for (ValidatorKernel kernel : {ValidatorKernel::scalar, ValidatorKernel::sse42, ValidatorKernel::avx2}) {
+        if (static_cast<int>(kernel) <= static_cast<int>(validator)) {
+            std::printf("%12s %14.1f MB/s\n", validatorKernelName(kernel), measureFind(kernel, 1u << 14, 200));
+        }
+    }
+    return 0;
+}
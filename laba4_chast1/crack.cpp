@@ -0,0 +1,103 @@
+/**
+ * @file crack.cpp
+ * @brief Восстановление утерянного ключа modAlphaCipher по шифротексту.
+ *
+ * @details
+ * Формат вызова:
+ * @code
+ * crack [--threads N] [--max-length L] [ФАЙЛ]
+ * @endcode
+ * Файл отображается в память; без файла (или с `-`) шифротекст читается из stdin.
+ * Ключ печатается в stdout, самые вероятные длины ключа и время анализа — в stderr.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "gronsfeldCrack.h"
+#include "../common/mappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Кодирует ключ в UTF-8 (буквы ключа — русские, по два байта).
+ */
+std::string keyToUtf8(const std::wstring& key) {
+    std::string result;
+    for (wchar_t c : key) {
+        result += static_cast<char>(0xC0 | (c >> 6));
+        result += static_cast<char>(0x80 | (c & 0x3F));
+    }
+    return result;
+}
+
+/**
+ * @brief Точка входа: разбирает аргументы, анализирует шифротекст и печатает ключ.
+ *
+ * @return int 0 при успехе, 1 при ошибке.
+ */
+int main(int argc, char** argv) {
+    CrackOptions options;
+    const char* file = "-";
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--max-length") == 0 && i + 1 < argc) {
+            options.maxKeyLength = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argv[i][0] != '-' || argv[i][1] == '\0') {
+            file = argv[i];
+        } else {
+            std::cerr << "Использование: " << argv[0] << " [--threads N] [--max-length L] [ФАЙЛ]\n";
+            return 1;
+        }
+    }
+    if (options.maxKeyLength == 0) {
+        std::cerr << "Ошибка: --max-length должна быть положительной." << std::endl;
+        return 1;
+    }
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        CrackResult result;
+        if (std::strcmp(file, "-") != 0) {
+            const MappedFile input{std::string(file)};
+            result = crackGronsfeld(std::string_view(input.data(), input.size()), options);
+        } else {
+            std::string text;
+            char block[1 << 16];
+            size_t read;
+            while ((read = std::fread(block, 1, sizeof(block), stdin)) > 0) {
+                text.append(block, read);
+            }
+            if (std::ferror(stdin)) {
+                std::cerr << "Ошибка чтения." << std::endl;
+                return 1;
+            }
+            result = crackGronsfeld(std::string_view(text), options);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::vector<KeyLengthScore> best = result.lengths;
+        std::sort(best.begin(), best.end(), [](const KeyLengthScore& a, const KeyLengthScore& b) {
+            return a.coincidence > b.coincidence;
+        });
+        best.resize(std::min<size_t>(best.size(), 5));
+        std::fprintf(stderr, "букв: %zu, время: %.3f с\nвероятные длины ключа:", result.letters, elapsed.count());
+        for (const KeyLengthScore& score : best) {
+            std::fprintf(stderr, " %zu (%.4f)", score.length, score.coincidence);
+        }
+        std::fprintf(stderr, "\n");
+        std::cout << keyToUtf8(result.key) << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
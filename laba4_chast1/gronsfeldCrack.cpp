@@ -0,0 +1,273 @@
+/**
+ * @file gronsfeldCrack.cpp
+ * @brief Восстановление ключа шифра Гронсвельда: длина ключа по совпадениям, буквы по χ².
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "gronsfeldCrack.h"
+#include "alphabet.h"
+#include "../common/parallel.h"
+#include "../common/russianFrequencies.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRACK_X86 1
+#endif
+
+namespace {
+
+using Tables = AlphabetTables<RussianAlphabet>;
+
+static_assert(russianFrequencies.size() == Tables::size, "frequencies follow the cipher alphabet");
+
+/**
+ * @brief Номер буквы по коду или Tables::invalidIndex.
+ */
+unsigned char indexOf(wchar_t code) {
+    const size_t offset = static_cast<size_t>(code) - static_cast<size_t>(Tables::tableBase);
+    return offset < Tables::tableSize ? Tables::index[offset] : Tables::invalidIndex;
+}
+
+/**
+ * @brief Дописывает номера русских букв из UTF-8, пропуская прочие символы.
+ */
+void appendLetters(const unsigned char* text, size_t length, std::vector<unsigned char>& out) {
+    for (size_t i = 0; i < length;) {
+        const unsigned char lead = text[i];
+        if ((lead & 0xE0) == 0xC0 && i + 1 < length && (text[i + 1] & 0xC0) == 0x80) {
+            const unsigned char index = indexOf(static_cast<wchar_t>(((lead & 0x1F) << 6) | (text[i + 1] & 0x3F)));
+            if (index != Tables::invalidIndex) {
+                out.push_back(index);
+            }
+            i += 2;
+        } else {
+            i++;
+        }
+    }
+}
+
+size_t countMatchesScalar(const unsigned char* a, const unsigned char* b, size_t length) {
+    size_t matches = 0;
+    for (size_t i = 0; i < length; i++) {
+        matches += a[i] == b[i];
+    }
+    return matches;
+}
+
+#ifdef CRACK_X86
+
+/**
+ * @brief Считает совпадающие байты по 16 за итерацию (SSE2).
+ *
+ * @details Совпадение даёт байт 0xFF, вычитание которого прибавляет 1 к счётчику
+ * в байте; не реже чем через 255 итераций байтовые счётчики суммируются через SAD
+ * (сумма в каждой половине не больше 8 · 255 и помещается в 16 бит).
+ */
+size_t countMatchesSse2(const unsigned char* a, const unsigned char* b, size_t length) {
+    size_t matches = 0;
+    size_t i = 0;
+    while (i + 16 <= length) {
+        const size_t end = std::min(length - 15, i + 255 * 16);
+        __m128i counts = _mm_setzero_si128();
+        for (; i < end; i += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(x, y));
+        }
+        const __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        matches += static_cast<size_t>(_mm_extract_epi16(sums, 0) + _mm_extract_epi16(sums, 4));
+    }
+    return matches + countMatchesScalar(a + i, b + i, length - i);
+}
+
+/**
+ * @brief Считает совпадающие байты по 32 за итерацию (AVX2).
+ */
+__attribute__((target("avx2")))
+size_t countMatchesAvx2(const unsigned char* a, const unsigned char* b, size_t length) {
+    size_t matches = 0;
+    size_t i = 0;
+    while (i + 32 <= length) {
+        const size_t end = std::min(length - 31, i + 255 * 32);
+        __m256i counts = _mm256_setzero_si256();
+        for (; i < end; i += 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+            counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(x, y));
+        }
+        const __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        matches += static_cast<size_t>(_mm256_extract_epi16(sums, 0) + _mm256_extract_epi16(sums, 4)
+                                       + _mm256_extract_epi16(sums, 8) + _mm256_extract_epi16(sums, 12));
+    }
+    _mm256_zeroupper();
+    return matches + countMatchesScalar(a + i, b + i, length - i);
+}
+
+#endif
+
+/**
+ * @brief Считает совпадающие байты лучшей реализацией, выбранной по CPUID.
+ */
+size_t countMatches(const unsigned char* a, const unsigned char* b, size_t length) {
+#ifdef CRACK_X86
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2 ? countMatchesAvx2(a, b, length) : countMatchesSse2(a, b, length);
+#else
+    return countMatchesScalar(a, b, length);
+#endif
+}
+
+} // namespace
+
+std::vector<unsigned char> letterIndices(std::string_view text, unsigned threads) {
+    threads = parallelThreads(threads, text.size());
+    const std::vector<size_t> bounds = splitUtf8(text.data(), text.size(), threads);
+    std::vector<std::vector<unsigned char>> parts(threads);
+    runParallel(threads, [&](unsigned part) {
+        parts[part].reserve((bounds[part + 1] - bounds[part]) / 2 + 1);
+        appendLetters(reinterpret_cast<const unsigned char*>(text.data()) + bounds[part],
+                      bounds[part + 1] - bounds[part], parts[part]);
+    });
+    if (threads == 1) {
+        return std::move(parts[0]);
+    }
+    std::vector<unsigned char> letters;
+    size_t total = 0;
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    letters.reserve(total);
+    for (const auto& part : parts) {
+        letters.insert(letters.end(), part.begin(), part.end());
+    }
+    return letters;
+}
+
+std::vector<unsigned char> letterIndices(const std::wstring& text) {
+    std::vector<unsigned char> letters;
+    letters.reserve(text.size());
+    for (wchar_t c : text) {
+        const unsigned char index = indexOf(c);
+        if (index != Tables::invalidIndex) {
+            letters.push_back(index);
+        }
+    }
+    return letters;
+}
+
+std::vector<KeyLengthScore> scoreKeyLengths(const unsigned char* letters, size_t count, size_t maxKeyLength,
+                                            unsigned threads) {
+    std::vector<KeyLengthScore> scores(maxKeyLength);
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, maxKeyLength)));
+    // Длины раздаются потокам через одну, чтобы короткие и длинные сдвиги делились поровну.
+    runParallel(threads, [&](unsigned part) {
+        for (size_t length = part + 1; length <= maxKeyLength; length += threads) {
+            const size_t pairs = count > length ? count - length : 0;
+            const size_t matches = countMatches(letters, letters + length, pairs);
+            scores[length - 1] = KeyLengthScore{length, pairs ? static_cast<double>(matches) / pairs : 0.0};
+        }
+    });
+    return scores;
+}
+
+size_t guessKeyLength(const std::vector<KeyLengthScore>& scores) {
+    if (scores.empty()) {
+        return 0;
+    }
+    double best = 0;
+    for (const KeyLengthScore& score : scores) {
+        best = std::max(best, score.coincidence);
+    }
+    const double threshold = (best + 1.0 / Tables::size) / 2;
+    for (const KeyLengthScore& score : scores) {
+        if (score.coincidence >= threshold) {
+            return score.length;
+        }
+    }
+    return scores.front().length;
+}
+
+std::wstring recoverKey(const unsigned char* letters, size_t count, size_t keyLength, unsigned threads) {
+    if (keyLength == 0) {
+        throw std::invalid_argument("Key length must be positive");
+    }
+    threads = parallelThreads(threads, count);
+    using Histogram = std::vector<std::array<size_t, Tables::size>>;
+    std::vector<Histogram> parts(threads, Histogram(keyLength));
+    runParallel(threads, [&](unsigned part) {
+        const size_t begin = count / threads * part;
+        const size_t end = part + 1 == threads ? count : count / threads * (part + 1);
+        Histogram& histogram = parts[part];
+        size_t column = begin % keyLength;
+        for (size_t i = begin; i < end; i++) {
+            histogram[column][letters[i]]++;
+            column = column + 1 == keyLength ? 0 : column + 1;
+        }
+    });
+
+    std::wstring key(keyLength, L'\0');
+    for (size_t column = 0; column < keyLength; column++) {
+        std::array<size_t, Tables::size> counts{};
+        size_t total = 0;
+        for (const Histogram& histogram : parts) {
+            for (size_t j = 0; j < Tables::size; j++) {
+                counts[j] += histogram[column][j];
+                total += histogram[column][j];
+            }
+        }
+        // Буква открытого текста j переходит в (j + k) mod 33: ищем k с наименьшим χ².
+        size_t bestShift = 0;
+        double bestChi = std::numeric_limits<double>::infinity();
+        for (size_t k = 0; k < Tables::size; k++) {
+            double chi = 0;
+            for (size_t j = 0; j < Tables::size; j++) {
+                const double expected = total * russianFrequencies[j];
+                const double diff = counts[(j + k) % Tables::size] - expected;
+                chi += diff * diff / expected;
+            }
+            if (chi < bestChi) {
+                bestChi = chi;
+                bestShift = k;
+            }
+        }
+        key[column] = Tables::letters[bestShift];
+    }
+    return key;
+}
+
+namespace {
+
+/**
+ * @brief Общая часть crackGronsfeld(): длина ключа по выборке, ключ по всему тексту.
+ */
+CrackResult crackLetters(const std::vector<unsigned char>& letters, const CrackOptions& options) {
+    if (letters.size() < 2) {
+        throw std::invalid_argument("Not enough letters to analyse");
+    }
+    CrackResult result;
+    result.letters = letters.size();
+    const size_t sample = std::min(letters.size(), std::max<size_t>(options.sampleLetters, 2));
+    const size_t maxKeyLength = std::max<size_t>(1, std::min(options.maxKeyLength, sample / 2));
+    result.lengths = scoreKeyLengths(letters.data(), sample, maxKeyLength, options.threads);
+    result.key = recoverKey(letters.data(), letters.size(), guessKeyLength(result.lengths), options.threads);
+    return result;
+}
+
+} // namespace
+
+CrackResult crackGronsfeld(std::string_view ciphertext, const CrackOptions& options) {
+    return crackLetters(letterIndices(ciphertext, options.threads), options);
+}
+
+CrackResult crackGronsfeld(const std::wstring& ciphertext, const CrackOptions& options) {
+    return crackLetters(letterIndices(ciphertext), options);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file gronsfeldCrack.h
+ * @brief Восстановление ключа шифра Гронсвельда (modAlphaCipher) по одному шифротексту.
+ *
+ * @details
+ * Ключ из русских букв делает шифр Гронсвельда шифром Виженера над алфавитом из 33 букв,
+ * поэтому ключ восстанавливается в два шага:
+ * 1. Длина ключа. Для каждого сдвига `L` считается доля совпадений `c[i] == c[i + L]`.
+ *    Если `L` кратно длине ключа, буквы в парах сдвинуты одинаково, и доля совпадений
+ *    близка к индексу совпадений русского текста (около 0,055), иначе — к 1/33.
+ *    Это статистическая форма метода Касиски: повторы на расстояниях, кратных длине
+ *    ключа. Сравнение векторное, сдвиги делятся между потоками.
+ * 2. Буквы ключа. Текст делится на столбцы по позиции в ключе, и для каждого столбца
+ *    выбирается сдвиг с наименьшим χ² относительно частот букв русского языка.
+ *
+ * Пробелы, знаки препинания и прочие символы вне алфавита пропускаются и не сдвигают
+ * ключ, как в потоковом режиме шифра.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Доля совпадений для одного сдвига.
+ */
+struct KeyLengthScore {
+    size_t length;      /**< Проверяемая длина ключа (сдвиг). */
+    double coincidence; /**< Доля пар `c[i] == c[i + length]`. */
+};
+
+/**
+ * @brief Параметры анализа.
+ */
+struct CrackOptions {
+    size_t maxKeyLength = 64;        /**< Наибольшая проверяемая длина ключа. */
+    size_t sampleLetters = 1 << 22;  /**< Сколько первых букв используется для поиска длины ключа. */
+    unsigned threads = 0;            /**< Число потоков (0 — по числу ядер). */
+};
+
+/**
+ * @brief Результат анализа.
+ */
+struct CrackResult {
+    std::wstring key;                    /**< Восстановленный ключ (наименьший период ключа). */
+    std::vector<KeyLengthScore> lengths; /**< Доля совпадений для каждой длины 1…maxKeyLength. */
+    size_t letters = 0;                  /**< Число букв шифротекста. */
+};
+
+/**
+ * @brief Переводит текст в номера букв русского алфавита, пропуская прочие символы.
+ *
+ * @param text Текст в UTF-8.
+ * @param threads Число потоков (0 — по числу ядер).
+ * @return std::vector<unsigned char> Номера букв 0…32.
+ */
+std::vector<unsigned char> letterIndices(std::string_view text, unsigned threads = 1);
+
+/**
+ * @brief То же для текста в wchar_t.
+ */
+std::vector<unsigned char> letterIndices(const std::wstring& text);
+
+/**
+ * @brief Считает долю совпадений для длин ключа 1…maxKeyLength.
+ *
+ * @param letters Номера букв.
+ * @param count Количество букв.
+ * @param maxKeyLength Наибольшая длина (не больше `count / 2`).
+ * @param threads Число потоков (0 — по числу ядер).
+ * @return std::vector<KeyLengthScore> Оценка для каждой длины по возрастанию.
+ */
+std::vector<KeyLengthScore> scoreKeyLengths(const unsigned char* letters, size_t count, size_t maxKeyLength,
+                                            unsigned threads = 0);
+
+/**
+ * @brief Выбирает длину ключа по долям совпадений.
+ *
+ * @details Кратные длины ключа дают такую же долю совпадений, как сама длина,
+ * поэтому выбирается наименьшая длина, чья доля ближе к наибольшей, чем к 1/33.
+ */
+size_t guessKeyLength(const std::vector<KeyLengthScore>& scores);
+
+/**
+ * @brief Восстанавливает ключ известной длины по χ² каждого столбца.
+ *
+ * @param letters Номера букв.
+ * @param count Количество букв.
+ * @param keyLength Длина ключа.
+ * @param threads Число потоков (0 — по числу ядер).
+ * @return std::wstring Ключ из русских букв.
+ */
+std::wstring recoverKey(const unsigned char* letters, size_t count, size_t keyLength, unsigned threads = 0);
+
+/**
+ * @brief Восстанавливает ключ по шифротексту в UTF-8.
+ *
+ * @param ciphertext Шифротекст.
+ * @param options Параметры анализа.
+ * @return CrackResult Ключ и оценки длин.
+ * @throws std::invalid_argument Если в тексте меньше двух букв.
+ */
+CrackResult crackGronsfeld(std::string_view ciphertext, const CrackOptions& options = CrackOptions());
+
+/**
+ * @brief Восстанавливает ключ по шифротексту в wchar_t.
+ *
+ * @throws std::invalid_argument Если в тексте меньше двух букв.
+ */
+CrackResult crackGronsfeld(const std::wstring& ciphertext, const CrackOptions& options = CrackOptions());
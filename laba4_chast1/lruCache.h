@@ -0,0 +1,91 @@
+/**
+ * @file lruCache.h
+ * @brief Потокобезопасный кэш с вытеснением давно не использованных записей (LRU).
+ *
+ * @details
+ * Значения хранятся как `std::shared_ptr<const Value>`: вытесненная запись
+ * остаётся жива, пока на неё ссылаются объекты, получившие её раньше.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @class LruCache
+ * @brief Кэш фиксированной ёмкости, защищённый мьютексом.
+ *
+ * @tparam Key Тип ключа (нужны `std::hash<Key>` и `operator==`).
+ * @tparam Value Тип значения.
+ */
+template <class Key, class Value>
+class LruCache {
+private:
+    using Entry = std::pair<Key, std::shared_ptr<const Value>>;
+
+    mutable std::mutex mutex; /**< Защищает список и индекс. */
+    size_t capacity;          /**< Наибольшее число записей. */
+    std::list<Entry> entries; /**< Записи от недавно использованных к давно не использованным. */
+    std::unordered_map<Key, typename std::list<Entry>::iterator> index; /**< Поиск записи по ключу. */
+
+public:
+    /**
+     * @brief Создаёт пустой кэш.
+     *
+     * @param capacity Наибольшее число записей (не меньше 1).
+     */
+    explicit LruCache(size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    /**
+     * @brief Возвращает значение по ключу, при промахе строит его вызовом `make(key)`.
+     *
+     * @details Значение строится без блокировки, поэтому медленное построение
+     * не задерживает другие потоки. Если два потока одновременно промахнулись
+     * по одному ключу, в кэше остаётся значение, добавленное первым.
+     * Исключение из `make` передаётся вызывающему, кэш не меняется.
+     *
+     * @param key Ключ.
+     * @param make Функция `Value(const Key&)`.
+     * @return std::shared_ptr<const Value> Значение.
+     */
+    template <class Make>
+    std::shared_ptr<const Value> get(const Key& key, const Make& make) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto found = index.find(key);
+            if (found != index.end()) {
+                entries.splice(entries.begin(), entries, found->second);
+                return found->second->second;
+            }
+        }
+        auto value = std::make_shared<const Value>(make(key));
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->second;
+        }
+        entries.emplace_front(key, value);
+        index.emplace(key, entries.begin());
+        if (entries.size() > capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        return value;
+    }
+
+    /**
+     * @brief Текущее число записей.
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+};
@@ -6,6 +6,14 @@
  * Работает только с заглавными буквами русского алфавита (включая 'Ё').
  * Реализована обработка ошибок.
  * 
+ * При запуске с аргументами работает в потоковом режиме без диалога:
+ * @code
+ * cipher -e -k КЛЮЧ < in.txt > out.txt
+ * cipher -d -k КЛЮЧ --threads 8 in.txt out.txt
+ * cipher -e -k КЛЮЧ --timing in.txt > out.txt
+ * cipher -e -k ΚΛΕΙΔΙ --alphabet greek.txt < in.txt > out.txt
+ * @endcode
+ * 
  * @author 
  * Бренинг И. А.
  * 
@@ -14,23 +22,82 @@
  */
 
 #include "modGronsfeld.h"
+#include "../common/streamMode.h"
+#include <cstdio>
 #include <iostream>
 #include <locale>
 
+/**
+ * @brief Размер блока чтения в потоковом режиме (байт).
+ */
+constexpr size_t chunkSize = 1 << 20;
+
 /**
  * @brief Проверяет корректность текста для шифрования/расшифрования.
  * 
+ * @details Допустимы только прописные русские буквы, как в алфавите шифра;
+ * проверка векторная и не зависит от локали (см. common/textValidator.h).
+ * 
  * @param s Текст для проверки.
  * @return true Если текст корректен.
  * @return false Если текст содержит недопустимые символы.
  */
 bool isValid(const std::wstring& s) {
-    for (auto c : s) {
-        if (!iswupper(c) && c != L'Ё') {
-            return false;
+    return isValidText(s, cyrillicUpper);
+}
+
+/**
+ * @brief Шифрует или расшифровывает поток блоками постоянного размера.
+ * 
+ * @details
+ * Поток читается блоками по `chunkSize` байт на поток и шифруется прямо в UTF-8,
+ * поэтому расход памяти не зависит от размера входа. Чтение, шифрование и запись
+ * идут одновременно на кольце буферов (см. runPipeline()). Пробельные символы
+ * копируются без изменений и не сдвигают ключ; позиция ключа переносится через
+ * границы блоков, так что результат совпадает с обработкой всего текста целиком.
+ * 
+ * @param cipher Шифр с установленным ключом.
+ * @param encrypt true для шифрования, false для расшифрования.
+ * @param threads Число потоков шифрования.
+ * @param in Входной поток.
+ * @param out Выходной поток.
+ * @return PipelineTiming Время чтения, шифрования и записи.
+ * @throws std::invalid_argument Если вход содержит недопустимые символы.
+ * @throws std::runtime_error При ошибке чтения или записи.
+ */
+template <class Cipher>
+PipelineTiming processStream(const Cipher& cipher, bool encrypt, unsigned threads, std::FILE* in,
+                             std::FILE* out) {
+    size_t phase = 0;
+    auto transform = [&](const char* block, size_t length, char* result) {
+        phase = encrypt ? cipher.encryptParallel(block, length, result, threads, phase)
+                        : cipher.decryptParallel(block, length, result, threads, phase);
+        return length;
+    };
+    return runPipeline(in, out, chunkSize * threads, 1, transform, "Ошибка чтения.", "Ошибка записи.");
+}
+
+/**
+ * @brief Потоковый режим: разбирает аргументы и обрабатывает файл или канал.
+ * 
+ * @details
+ * Аргументы, файлы и вывод времени и счётчиков — общие с другими программами (см. common/streamMode.h).
+ * `--alphabet ФАЙЛ` загружает алфавит (буквы одной длины в UTF-8) и шифрует runtimeGronsfeld;
+ * по умолчанию — русский алфавит modAlphaCipher с таблицами времени компиляции.
+ * Если указаны оба файла, они отображаются в память (см. modAlphaCipher::encryptFile()).
+ * 
+ * @return int 0 при успехе, 1 при ошибке.
+ */
+int runStream(int argc, char** argv) {
+    return runStreamMode(argc, argv, [](const StreamOptions& options, StreamSession& session) {
+        const std::wstring key = decodeKey(options.key);
+        if (options.alphabetFile != nullptr) {
+            session.run(runtimeGronsfeld(key, Alphabet::fromFile(options.alphabetFile)),
+                        processStream<runtimeGronsfeld>);
+        } else {
+            session.run(modAlphaCipher(key), processStream<modAlphaCipher>);
         }
-    }
-    return true;
+    });
 }
 
 /**
@@ -42,10 +109,15 @@ bool isValid(const std::wstring& s) {
  * - Выбор операции (шифрование, расшифрование или выход).
  * - Ввод текста для обработки.
  * Реализована валидация ключа и текста, а также обработка исключений.
+ * При наличии аргументов командной строки запускается потоковый режим (см. runStream()).
  * 
  * @return 0 Если программа завершена корректно.
  */
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return runStream(argc, argv);
+    }
+
     try {
         std::locale loc("ru_RU.UTF-8");
         std::locale::global(loc);
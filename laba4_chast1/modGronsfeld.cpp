@@ -1,15 +1,20 @@
 /**
  * @file modGronsfeld.cpp
- * @brief Реализация методов класса modAlphaCipher.
+ * @brief Реализация методов шаблона BasicGronsfeld.
  * 
  * Этот файл содержит реализацию всех методов, включая конструктор, шифрование, расшифрование,
- * и вспомогательные функции преобразования строки в числовой вектор и обратно.
+ * преобразование ключа в числовой вектор и общий однопроходный сдвиг текста.
  * 
  * @details
  * Реализована обработка ошибок. Ключ и текст валидируются на корректность символов.
+ * Шаблон явно инстанцируется в конце файла для русского, латинского
+ * и объединённого алфавитов (см. alphabet.h), а также для алфавита
+ * времени работы (common/runtimeAlphabet.h).
  * 
  * @note
- * Все ошибки выбрасываются в виде исключений `std::invalid_argument`.
+ * Все ошибки выбрасываются в виде исключений `std::invalid_argument`. Ядра shift() и shiftUtf8()
+ * возвращают код результата; методы, выбрасывающие исключения, переводят его в исключение (unwrap()),
+ * а `tryEncrypt`/`tryDecrypt` возвращают как есть.
  * 
  * @author 
  * Бренинг И. А.
@@ -19,61 +24,617 @@
  */
 
 #include "modGronsfeld.h"
+#include "lruCache.h"
+#include "shiftKernel.h"
+#include "../common/mappedFile.h"
+#include "../common/metrics.h"
+#include "../common/parallel.h"
+#include "../common/utf8.h"
+#include <algorithm>
+#include <cstring>
 
-modAlphaCipher::modAlphaCipher(const std::wstring& skey) {
+namespace {
+
+/**
+ * @brief Пробельные символы, которые в UTF-8-режиме копируются без шифрования.
+ */
+bool isSpace(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * @brief Считает буквы в тексте UTF-8: для многобайтовых букв — по первым байтам,
+ * для однобайтовых — все байты, кроме пробельных.
+ */
+size_t countLetters(const char* text, size_t length, size_t width) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        count += width >= 2 ? (c & 0xC0) == 0xC0 : !isSpace(c);
+    }
+    return count;
+}
+
+/**
+ * @brief Переводит код результата в исключение.
+ *
+ * @return size_t Позиция ключа после текста, если ошибки нет.
+ */
+size_t unwrap(const CipherResult& result) {
+    if (result.status == CipherStatus::unsupportedAlphabet) {
+        throw std::invalid_argument("UTF-8 interface requires letters of equal UTF-8 length");
+    }
+    if (!result) {
+        throw std::invalid_argument("Invalid character in input.");
+    }
+    return result.phase;
+}
+
+/**
+ * @brief Проверяет, что смещения пакета неубывают и не выходят за текст.
+ */
+void checkBatch(const MessageBatch& batch) {
+    if (batch.offsets.empty() || !std::is_sorted(batch.offsets.begin(), batch.offsets.end())
+        || batch.offsets.back() > batch.text.size()) {
+        throw std::invalid_argument("Invalid batch offsets");
+    }
+}
+
+} // namespace
+
+template <class Alphabet>
+BasicGronsfeld<Alphabet>::BasicGronsfeld(const std::wstring& skey) : BasicGronsfeld(skey, defaultAlphabet()) {}
+
+template <class Alphabet>
+BasicGronsfeld<Alphabet>::BasicGronsfeld(const std::wstring& skey, const Alphabet& alphabet) {
     if (skey.empty()) {
         throw std::invalid_argument("Key cannot be empty");
     }
 
-    for (size_t i = 0; i < numAlpha.size(); i++) {
-        alphaNum[numAlpha[i]] = i;
+    static LruCache<std::wstring, KeySchedule> cache(keyCacheSize);
+    auto make = [&](const std::wstring&) { return makeSchedule(skey, alphabet); };
+    if constexpr (runtimeAlphabet) {
+        // В буквах алфавита нет перевода строки, поэтому запись кэша однозначна.
+        schedule = cache.get(alphabet.letters() + L'\n' + skey, make);
+    } else {
+        schedule = cache.get(skey, make);
     }
+}
 
-    key = convert(skey);
+template <class Alphabet>
+typename BasicGronsfeld<Alphabet>::KeySchedule BasicGronsfeld<Alphabet>::makeSchedule(const std::wstring& skey,
+                                                                                     const Alphabet& alphabet) {
+    KeySchedule result(alphabet);
+    if constexpr (runtimeAlphabet) {
+        result.utf8.assign(4 * alphabet.size(), '\0');
+        result.utf8Width = encodeUtf8Char(alphabet.letter(0), &result.utf8[0]);
+        for (size_t i = 1; i < alphabet.size(); i++) {
+            if (encodeUtf8Char(alphabet.letter(i), &result.utf8[4 * i]) != result.utf8Width) {
+                result.utf8Width = 0;
+            }
+        }
+    }
+    const int size = static_cast<int>(withLetters(result, [&](const auto& letters) {
+        result.key = convert(skey, letters);
+        return letters.size();
+    }));
+    const std::vector<int>& key = result.key;
+    result.keyStream.resize(key.size() + blockSize);
+    result.inverseKeyStream.resize(key.size() + blockSize);
+    for (size_t i = 0; i < result.keyStream.size(); i++) {
+        const int k = key[i % key.size()];
+        result.keyStream[i] = static_cast<unsigned char>(k);
+        result.inverseKeyStream[i] = static_cast<unsigned char>((size - k) % size);
+    }
+    return result;
 }
 
-std::vector<int> modAlphaCipher::convert(const std::wstring& s) {
+template <class Alphabet>
+template <class Letters>
+std::vector<int> BasicGronsfeld<Alphabet>::convert(const std::wstring& s, const Letters& letters) {
+    if (letters.findInvalid(s.data(), s.size()) != s.size()) {
+        throw std::invalid_argument("Invalid character in input.");
+    }
+    const auto index = letters.lookup();
     std::vector<int> result;
+    result.reserve(s.size());
     for (auto c : s) {
-        if (alphaNum.find(c) == alphaNum.end()) {
-            throw std::invalid_argument("Invalid character in input.");
-        }
-        result.push_back(alphaNum[c]);
+        result.push_back(index(c));
     }
     return result;
 }
 
-std::wstring modAlphaCipher::convert(const std::vector<int>& v) {
-    std::wstring result;
-    for (auto i : v) {
-        if (i < 0 || i >= static_cast<int>(numAlpha.size())) {
-            throw std::invalid_argument("Index out of range.");
+template <class Alphabet>
+CipherResult BasicGronsfeld<Alphabet>::shift(const wchar_t* text, size_t length, wchar_t* out,
+                                             const std::vector<unsigned char>& stream, size_t phase) const noexcept {
+    return withLetters(*schedule, [&](const auto& letters) noexcept {
+        const wchar_t* symbols = letters.symbols();
+        const auto index = letters.lookup();
+        const unsigned modulus = static_cast<unsigned>(letters.size());
+        unsigned char block[blockSize];
+        phase %= schedule->key.size();
+        METRIC_COUNT(calls, 1);
+        METRIC_COUNT(bytes, length * sizeof(wchar_t));
+        for (size_t pos = 0; pos < length; pos += blockSize) {
+            const size_t n = std::min(blockSize, length - pos);
+            const size_t invalid = METRIC_TIME(validate, letters.findInvalid(text + pos, n));
+            if (invalid != n) {
+                METRIC_COUNT(rejections, 1);
+                return CipherResult{CipherStatus::invalidCharacter, pos + invalid, phase};
+            }
+            {
+                METRIC_PHASE(convert);
+                for (size_t i = 0; i < n; i++) {
+                    block[i] = index(text[pos + i]);
+                }
+            }
+            METRIC_TIME(shift, shiftIndices(block, stream.data() + phase, n, modulus, block));
+            {
+                METRIC_PHASE(convert);
+                for (size_t i = 0; i < n; i++) {
+                    out[pos + i] = symbols[block[i]];
+                }
+            }
+            phase = (phase + n) % schedule->key.size();
         }
-        result += numAlpha[i];
+        return CipherResult{CipherStatus::ok, length, phase};
+    });
+}
+
+template <class Alphabet>
+std::wstring BasicGronsfeld<Alphabet>::encrypt(const std::wstring& open_text) const {
+    if (open_text.empty()) {
+        throw std::invalid_argument("Text cannot be empty");
     }
+
+    std::wstring result = METRIC_TIME(allocate, std::wstring(open_text.size(), L'\0'));
+    METRIC_COUNT(allocations, 1);
+    unwrap(shift(open_text.data(), open_text.size(), &result[0], schedule->keyStream, 0));
     return result;
 }
 
-std::wstring modAlphaCipher::encrypt(const std::wstring& open_text) {
-    if (open_text.empty()) {
+template <class Alphabet>
+std::wstring BasicGronsfeld<Alphabet>::decrypt(const std::wstring& cipher_text) const {
+    if (cipher_text.empty()) {
         throw std::invalid_argument("Text cannot be empty");
     }
 
-    std::vector<int> work = convert(open_text);
-    for (size_t i = 0; i < work.size(); i++) {
-        work[i] = (work[i] + key[i % key.size()]) % numAlpha.size();
+    std::wstring result = METRIC_TIME(allocate, std::wstring(cipher_text.size(), L'\0'));
+    METRIC_COUNT(allocations, 1);
+    unwrap(shift(cipher_text.data(), cipher_text.size(), &result[0], schedule->inverseKeyStream, 0));
+    return result;
+}
+
+template <class Alphabet>
+std::string BasicGronsfeld<Alphabet>::encrypt(std::string_view open_text) const {
+    if (open_text.empty()) {
+        throw std::invalid_argument("Text cannot be empty");
     }
-    return convert(work);
+
+    std::string result = METRIC_TIME(allocate, std::string(open_text.size(), '\0'));
+    METRIC_COUNT(allocations, 1);
+    unwrap(shiftUtf8(open_text.data(), open_text.size(), &result[0], schedule->keyStream, 0, false));
+    return result;
 }
 
-std::wstring modAlphaCipher::decrypt(const std::wstring& cipher_text) {
+template <class Alphabet>
+std::string BasicGronsfeld<Alphabet>::decrypt(std::string_view cipher_text) const {
     if (cipher_text.empty()) {
         throw std::invalid_argument("Text cannot be empty");
     }
 
-    std::vector<int> work = convert(cipher_text);
-    for (size_t i = 0; i < work.size(); i++) {
-        work[i] = (work[i] + numAlpha.size() - key[i % key.size()]) % numAlpha.size();
+    std::string result = METRIC_TIME(allocate, std::string(cipher_text.size(), '\0'));
+    METRIC_COUNT(allocations, 1);
+    unwrap(shiftUtf8(cipher_text.data(), cipher_text.size(), &result[0], schedule->inverseKeyStream, 0, false));
+    return result;
+}
+
+template <class Alphabet>
+size_t BasicGronsfeld<Alphabet>::encrypt(const wchar_t* open_text, size_t length, wchar_t* out, size_t phase) const {
+    return unwrap(shift(open_text, length, out, schedule->keyStream, phase));
+}
+
+template <class Alphabet>
+size_t BasicGronsfeld<Alphabet>::decrypt(const wchar_t* cipher_text, size_t length, wchar_t* out, size_t phase) const {
+    return unwrap(shift(cipher_text, length, out, schedule->inverseKeyStream, phase));
+}
+
+template <class Alphabet>
+CipherResult BasicGronsfeld<Alphabet>::tryEncrypt(const wchar_t* open_text, size_t length, wchar_t* out,
+                                                  size_t phase) const noexcept {
+    return shift(open_text, length, out, schedule->keyStream, phase);
+}
+
+template <class Alphabet>
+CipherResult BasicGronsfeld<Alphabet>::tryDecrypt(const wchar_t* cipher_text, size_t length, wchar_t* out,
+                                                  size_t phase) const noexcept {
+    return shift(cipher_text, length, out, schedule->inverseKeyStream, phase);
+}
+
+template <class Alphabet>
+template <bool gather>
+void BasicGronsfeld<Alphabet>::shiftStrided(const wchar_t* text, wchar_t* out, size_t start, size_t stride,
+                                            size_t count, const std::vector<unsigned char>& stream) const {
+    withLetters(*schedule, [&](const auto& letters) {
+        const wchar_t* symbols = letters.symbols();
+        const size_t size = letters.size();
+        const size_t keySize = schedule->key.size();
+        const size_t step = stride % keySize;
+        size_t phase = start % keySize;
+        METRIC_COUNT(calls, 1);
+        METRIC_COUNT(bytes, count * sizeof(wchar_t));
+        for (size_t k = 0, pos = start; k < count; k++, pos += stride) {
+            const int index = letters.indexOf(gather ? text[pos] : text[k]);
+            if (index == letters.invalidIndex) {
+                METRIC_COUNT(rejections, 1);
+                throw std::invalid_argument("Invalid character in input.");
+            }
+            // Шаг позиции ключа меньше длины ключа, поэтому вместо деления — одно вычитание.
+            size_t shifted = index + stream[phase];
+            shifted -= shifted >= size ? size : 0;
+            (gather ? out[k] : out[pos]) = symbols[shifted];
+            phase += step;
+            phase -= phase >= keySize ? keySize : 0;
+        }
+    });
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::encryptStrided(const wchar_t* open_text, size_t start, size_t stride, size_t count,
+                                              wchar_t* out) const {
+    shiftStrided<true>(open_text, out, start, stride, count, schedule->keyStream);
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::decryptStrided(const wchar_t* cipher_text, size_t count, wchar_t* out, size_t start,
+                                              size_t stride) const {
+    shiftStrided<false>(cipher_text, out, start, stride, count, schedule->inverseKeyStream);
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::shiftBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out,
+                                          const std::vector<unsigned char>& stream, bool resetKey) const {
+    const size_t begin = offsets[0];
+    const size_t end = offsets[count];
+    if (!resetKey) {
+        unwrap(shift(text + begin, end - begin, out + begin, stream, 0));
+        return;
+    }
+    withLetters(*schedule, [&](const auto& letters) {
+        const wchar_t* symbols = letters.symbols();
+        const auto index = letters.lookup();
+        const unsigned modulus = static_cast<unsigned>(letters.size());
+        unsigned char block[blockSize];
+        unsigned char shifts[blockSize];
+        size_t message = 0;
+        size_t phase = 0;
+        METRIC_COUNT(calls, 1);
+        METRIC_COUNT(bytes, (end - begin) * sizeof(wchar_t));
+        for (size_t pos = begin; pos < end; pos += blockSize) {
+            const size_t n = std::min(blockSize, end - pos);
+            if (METRIC_TIME(validate, letters.findInvalid(text + pos, n)) != n) {
+                METRIC_COUNT(rejections, 1);
+                throw std::invalid_argument("Invalid character in input.");
+            }
+            {
+                METRIC_PHASE(convert);
+                for (size_t i = 0; i < n; i++) {
+                    block[i] = index(text[pos + i]);
+                }
+            }
+            for (size_t i = 0; i < n;) {
+                while (offsets[message + 1] <= pos + i) {
+                    message++;
+                    phase = 0;
+                }
+                const size_t run = std::min(n - i, offsets[message + 1] - (pos + i));
+                std::memcpy(shifts + i, stream.data() + phase, run);
+                phase = (phase + run) % schedule->key.size();
+                i += run;
+            }
+            METRIC_TIME(shift, shiftIndices(block, shifts, n, modulus, block));
+            {
+                METRIC_PHASE(convert);
+                for (size_t i = 0; i < n; i++) {
+                    out[pos + i] = symbols[block[i]];
+                }
+            }
+        }
+    });
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::encryptBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out,
+                                            bool resetKey) const {
+    shiftBatch(text, offsets, count, out, schedule->keyStream, resetKey);
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::decryptBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out,
+                                            bool resetKey) const {
+    shiftBatch(text, offsets, count, out, schedule->inverseKeyStream, resetKey);
+}
+
+template <class Alphabet>
+MessageBatch BasicGronsfeld<Alphabet>::encryptBatch(const MessageBatch& batch, bool resetKey) const {
+    checkBatch(batch);
+    MessageBatch result{std::wstring(batch.text.size(), L'\0'), batch.offsets};
+    encryptBatch(batch.text.data(), batch.offsets.data(), batch.offsets.size() - 1, &result.text[0], resetKey);
+    return result;
+}
+
+template <class Alphabet>
+MessageBatch BasicGronsfeld<Alphabet>::decryptBatch(const MessageBatch& batch, bool resetKey) const {
+    checkBatch(batch);
+    MessageBatch result{std::wstring(batch.text.size(), L'\0'), batch.offsets};
+    decryptBatch(batch.text.data(), batch.offsets.data(), batch.offsets.size() - 1, &result.text[0], resetKey);
+    return result;
+}
+
+template <class Alphabet>
+CipherResult BasicGronsfeld<Alphabet>::shiftUtf8(const char* text, size_t length, char* out,
+                                                 const std::vector<unsigned char>& stream, size_t phase,
+                                                 bool keepSpaces) const noexcept {
+    if constexpr (!runtimeAlphabet) {
+        constexpr size_t width = FixedLetters<Alphabet>::utf8Width();
+        if constexpr (width == 0) {
+            return CipherResult{CipherStatus::unsupportedAlphabet, 0, phase};
+        } else {
+            return shiftUtf8Letters<width>(FixedLetters<Alphabet>{}, text, length, out, stream, phase, keepSpaces);
+        }
+    } else {
+        // Длина буквы известна только во время работы: ядро собрано для каждой.
+        return withLetters(*schedule, [&](const auto& letters) noexcept {
+            switch (letters.utf8Width()) {
+            case 1:
+                return shiftUtf8Letters<1>(letters, text, length, out, stream, phase, keepSpaces);
+            case 2:
+                return shiftUtf8Letters<2>(letters, text, length, out, stream, phase, keepSpaces);
+            case 3:
+                return shiftUtf8Letters<3>(letters, text, length, out, stream, phase, keepSpaces);
+            case 4:
+                return shiftUtf8Letters<4>(letters, text, length, out, stream, phase, keepSpaces);
+            default:
+                return CipherResult{CipherStatus::unsupportedAlphabet, 0, phase};
+            }
+        });
+    }
+}
+
+template <class Alphabet>
+template <size_t width, class Letters>
+CipherResult BasicGronsfeld<Alphabet>::shiftUtf8Letters(const Letters& letters, const char* text, size_t length,
+                                                        char* out, const std::vector<unsigned char>& stream,
+                                                        size_t phase, bool keepSpaces) const noexcept {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(text);
+    const char* bytes = letters.utf8();
+    const unsigned modulus = static_cast<unsigned>(letters.size());
+    unsigned char block[blockSize];
+    phase %= schedule->key.size();
+    METRIC_COUNT(calls, 1);
+    METRIC_COUNT(bytes, length);
+    size_t pos = 0;
+    while (pos < length) {
+        // Первый проход: номера букв в блок, пробелы сразу в результат.
+        // Разбор UTF-8 и проверка букв слиты в один цикл и считаются преобразованием.
+        size_t end = pos;
+        size_t n = 0;
+        {
+            METRIC_PHASE(convert);
+            while (end < length && n < blockSize) {
+                const unsigned char lead = in[end];
+                if (isSpace(lead) && keepSpaces) {
+                    out[end++] = static_cast<char>(lead);
+                    continue;
+                }
+                wchar_t code = lead;
+                if constexpr (width == 2) {
+                    if (end + 1 == length || (lead & 0xE0) != 0xC0 || (in[end + 1] & 0xC0) != 0x80) {
+                        METRIC_COUNT(rejections, 1);
+                        return CipherResult{CipherStatus::invalidCharacter, end, phase};
+                    }
+                    code = static_cast<wchar_t>(((lead & 0x1F) << 6) | (in[end + 1] & 0x3F));
+                } else if constexpr (width > 2) {
+                    std::uint32_t decoded;
+                    if (decodeUtf8Char(text + end, length - end, decoded) != width) {
+                        METRIC_COUNT(rejections, 1);
+                        return CipherResult{CipherStatus::invalidCharacter, end, phase};
+                    }
+                    code = static_cast<wchar_t>(decoded);
+                }
+                const int index = letters.indexOf(code);
+                if (index == letters.invalidIndex) {
+                    METRIC_COUNT(rejections, 1);
+                    return CipherResult{CipherStatus::invalidCharacter, end, phase};
+                }
+                block[n++] = static_cast<unsigned char>(index);
+                end += width;
+            }
+        }
+
+        METRIC_TIME(shift, shiftIndices(block, stream.data() + phase, n, modulus, block));
+
+        // Второй проход: буквы на те же места, что и во входе.
+        METRIC_PHASE(convert);
+        size_t k = 0;
+        for (size_t i = pos; i < end;) {
+            if (isSpace(in[i])) {
+                i++;
+                continue;
+            }
+            const char* letter = bytes + Letters::utf8Stride * block[k];
+            for (size_t j = 0; j < width; j++) {
+                out[i + j] = letter[j];
+            }
+            k++;
+            i += width;
+        }
+        phase = (phase + n) % schedule->key.size();
+        pos = end;
+    }
+    return CipherResult{CipherStatus::ok, length, phase};
+}
+
+template <class Alphabet>
+size_t BasicGronsfeld<Alphabet>::encrypt(const char* open_text, size_t length, char* out, size_t phase) const {
+    return unwrap(shiftUtf8(open_text, length, out, schedule->keyStream, phase));
+}
+
+template <class Alphabet>
+size_t BasicGronsfeld<Alphabet>::decrypt(const char* cipher_text, size_t length, char* out, size_t phase) const {
+    return unwrap(shiftUtf8(cipher_text, length, out, schedule->inverseKeyStream, phase));
+}
+
+template <class Alphabet>
+CipherResult BasicGronsfeld<Alphabet>::tryEncrypt(const char* open_text, size_t length, char* out,
+                                                  size_t phase) const noexcept {
+    return shiftUtf8(open_text, length, out, schedule->keyStream, phase);
+}
+
+template <class Alphabet>
+CipherResult BasicGronsfeld<Alphabet>::tryDecrypt(const char* cipher_text, size_t length, char* out,
+                                                  size_t phase) const noexcept {
+    return shiftUtf8(cipher_text, length, out, schedule->inverseKeyStream, phase);
+}
+
+template <class Alphabet>
+size_t BasicGronsfeld<Alphabet>::shiftUtf8Parallel(const char* text, size_t length, char* out,
+                                                   const std::vector<unsigned char>& stream, size_t phase,
+                                                   unsigned threads) const {
+    threads = parallelThreads(threads, length);
+    if (threads == 1) {
+        return unwrap(shiftUtf8(text, length, out, stream, phase));
     }
-    return convert(work);
+    const size_t width = withLetters(*schedule, [](const auto& letters) { return letters.utf8Width(); });
+    // Блок считает свои буквы, пока он в кэше, получает позицию ключа от предыдущего блока и сразу шифруется.
+    const size_t blocks = (length + parallelBlock - 1) / parallelBlock;
+    BlockChain phases(blocks, phase % schedule->key.size());
+    runBlocks(threads, blocks, [&](size_t block) {
+        const size_t begin = utf8Boundary(text, length, block * parallelBlock);
+        const size_t end = utf8Boundary(text, length, (block + 1) * parallelBlock);
+        const size_t letters = countLetters(text + begin, end - begin, width);
+        const size_t start = phases.wait(block);
+        phases.publish(block, (start + letters) % schedule->key.size());
+        unwrap(shiftUtf8(text + begin, end - begin, out + begin, stream, start));
+    }, phases);
+    return phases.wait(blocks);
 }
+
+template <class Alphabet>
+size_t BasicGronsfeld<Alphabet>::encryptParallel(const char* open_text, size_t length, char* out, unsigned threads,
+                                                 size_t phase) const {
+    return shiftUtf8Parallel(open_text, length, out, schedule->keyStream, phase, threads);
+}
+
+template <class Alphabet>
+size_t BasicGronsfeld<Alphabet>::decryptParallel(const char* cipher_text, size_t length, char* out, unsigned threads,
+                                                 size_t phase) const {
+    return shiftUtf8Parallel(cipher_text, length, out, schedule->inverseKeyStream, phase, threads);
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::shiftFile(const std::string& input, const std::string& output,
+                                         const std::vector<unsigned char>& stream, unsigned threads) const {
+    MappedFile in(input);
+    MappedFile out(output, in.size());
+    shiftUtf8Parallel(in.data(), in.size(), out.data(), stream, 0, threads);
+    out.commit();
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::encryptFile(const std::string& input, const std::string& output, unsigned threads) const {
+    shiftFile(input, output, schedule->keyStream, threads);
+}
+
+template <class Alphabet>
+void BasicGronsfeld<Alphabet>::decryptFile(const std::string& input, const std::string& output, unsigned threads) const {
+    shiftFile(input, output, schedule->inverseKeyStream, threads);
+}
+
+template <class Alphabet>
+CipherStream<BasicGronsfeld<Alphabet>>::CipherStream(const BasicGronsfeld<Alphabet>& cipher, bool forward)
+    : cipher(cipher), forward(forward) {}
+
+template <class Alphabet>
+size_t CipherStream<BasicGronsfeld<Alphabet>>::update(const wchar_t* in, size_t length, wchar_t* out) {
+    phase = forward ? cipher.encrypt(in, length, out, phase) : cipher.decrypt(in, length, out, phase);
+    return length;
+}
+
+template <class Alphabet>
+std::wstring CipherStream<BasicGronsfeld<Alphabet>>::update(const std::wstring& fragment) {
+    std::wstring result(fragment.size(), L'\0');
+    update(fragment.data(), fragment.size(), &result[0]);
+    return result;
+}
+
+template <class Alphabet>
+size_t CipherStream<BasicGronsfeld<Alphabet>>::shiftUtf8(const char* in, size_t length, char* out, size_t from) const {
+    return forward ? cipher.encrypt(in, length, out, from) : cipher.decrypt(in, length, out, from);
+}
+
+template <class Alphabet>
+size_t CipherStream<BasicGronsfeld<Alphabet>>::update(const char* in, size_t length, char* out) {
+    // Позиция ключа и оборванная буква меняются только после успешной обработки всего фрагмента.
+    size_t next = phase;
+    size_t written = 0;
+    char letter[4];
+    size_t have = carried;
+    std::memcpy(letter, carry, carried);
+    if (have > 0) {
+        const size_t size = utf8CharLength(static_cast<unsigned char>(letter[0]));
+        const size_t taken = std::min(size - have, length);
+        for (size_t i = 0; i < taken; i++) {
+            if ((static_cast<unsigned char>(in[i]) & 0xC0) != 0x80) {
+                throw std::invalid_argument("Invalid character in input.");
+            }
+            letter[have++] = in[i];
+        }
+        in += taken;
+        length -= taken;
+        if (have == size) {
+            next = shiftUtf8(letter, size, out, next);
+            written = size;
+            have = 0;
+        }
+    }
+    // Многобайтовая буква может разорваться границей фрагмента: её начало ждёт следующего.
+    const size_t tail = utf8Tail(in, length);
+    next = shiftUtf8(in, length - tail, out + written, next);
+    written += length - tail;
+    if (tail > 0) {
+        std::memcpy(letter, in + length - tail, tail);
+        have = tail;
+    }
+    std::memcpy(carry, letter, have);
+    carried = have;
+    phase = next;
+    return written;
+}
+
+template <class Alphabet>
+std::string CipherStream<BasicGronsfeld<Alphabet>>::update(std::string_view fragment) {
+    std::string result(fragment.size() + 3, '\0');
+    result.resize(update(fragment.data(), fragment.size(), &result[0]));
+    return result;
+}
+
+template <class Alphabet>
+size_t CipherStream<BasicGronsfeld<Alphabet>>::finalize(wchar_t*) {
+    const bool truncated = carried > 0;
+    phase = 0;
+    carried = 0;
+    if (truncated) {
+        throw std::invalid_argument("Invalid character in input.");
+    }
+    return 0;
+}
+
+template class BasicGronsfeld<RussianAlphabet>;
+template class BasicGronsfeld<LatinAlphabet>;
+template class BasicGronsfeld<CombinedAlphabet>;
+template class BasicGronsfeld<Alphabet>;
+template class CipherStream<BasicGronsfeld<RussianAlphabet>>;
+template class CipherStream<BasicGronsfeld<LatinAlphabet>>;
+template class CipherStream<BasicGronsfeld<CombinedAlphabet>>;
+template class CipherStream<BasicGronsfeld<Alphabet>>;
@@ -2,11 +2,16 @@
  * @file modGronsfeld.h
  * @brief Заголовочный файл для шифра Гронсвельда.
  * 
- * Содержит описание класса `modAlphaCipher`, реализующего алгоритм шифрования.
- * Алгоритм работает с русским алфавитом (включая 'Ё').
+ * Содержит описание шаблона `BasicGronsfeld`, реализующего алгоритм шифрования
+ * над алфавитом, заданным на этапе компиляции (см. alphabet.h), и псевдонимов
+ * для русского, латинского и объединённого алфавитов. `modAlphaCipher` — шифр
+ * над русским алфавитом (включая 'Ё'). `runtimeGronsfeld` — тот же шифр над
+ * алфавитом, заданным во время работы объектом Alphabet (common/runtimeAlphabet.h).
  * 
  * @details
- * Все методы выбрасывают исключения `std::invalid_argument` при ошибках ввода.
+ * Все методы выбрасывают исключения `std::invalid_argument` при ошибках ввода,
+ * кроме `tryEncrypt`/`tryDecrypt`: они не выбрасывают исключений и возвращают
+ * код результата и позицию первого недопустимого символа (CipherResult).
  * 
  * @author 
  * Бренинг И. А.
@@ -16,54 +21,248 @@
  */
 
 #pragma once
+#include "alphabet.h"
+#include "../common/cipherResult.h"
+#include <array>
+#include <memory>
 #include <string>
-#include <map>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include <stdexcept>
 #include <iostream>
 
 /**
- * @class modAlphaCipher
- * @brief Класс шифра Гронсвельда.
+ * @brief Пакет сообщений, записанных подряд в одной строке.
+ *
+ * @details Сообщение `i` занимает символы `[offsets[i], offsets[i + 1])`,
+ * поэтому у пакета из `n` сообщений `n + 1` смещение.
+ */
+struct MessageBatch {
+    std::wstring text;           /**< Сообщения подряд, без разделителей. */
+    std::vector<size_t> offsets; /**< Границы сообщений. */
+};
+
+/**
+ * @class BasicGronsfeld
+ * @brief Шаблон шифра Гронсвельда над алфавитом, заданным на этапе компиляции или во время работы.
  * 
  * @details
- * Работает с текстом, содержащим только заглавные буквы русского алфавита, включая 'Ё'.
+ * Работает с текстом, содержащим только буквы алфавита `Alphabet`.
  * Ключ преобразуется в числовой вектор, на основе которого выполняются операции шифрования и расшифрования.
+ * Для алфавита времени компиляции таблица индексов и буквы в UTF-8 строятся компилятором
+ * (см. AlphabetTables) и общие для всех объектов, а размер алфавита — константа.
+ * `BasicGronsfeld<Alphabet>` с классом Alphabet из common/runtimeAlphabet.h получает
+ * алфавит в конструкторе и хранит его вместе с расписанием ключа; горячие циклы те же
+ * (см. FixedLetters и LoadedLetters).
+ * 
+ * Интерфейс над байтами UTF-8 требует, чтобы все буквы алфавита имели одинаковую
+ * длину в UTF-8 (русский — 2 байта, латинский — 1, у алфавита времени работы — до 4):
+ * тогда результат имеет ту же длину, что и вход. Для объединённого алфавита он
+ * выбрасывает исключение.
+ * 
+ * @tparam Alphabet Тип алфавита (RussianAlphabet, LatinAlphabet, CombinedAlphabet или Alphabet).
  */
-class modAlphaCipher {
+template <class Alphabet>
+class BasicGronsfeld {
 private:
-    std::wstring numAlpha = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ"; /**< Русский алфавит. */
-    std::map<wchar_t, int> alphaNum; /**< Карта символов и их индексов. */
-    std::vector<int> key; /**< Ключ в числовом формате. */
+    static constexpr bool runtimeAlphabet = std::is_same<Alphabet, ::Alphabet>::value; /**< Алфавит задан объектом. */
+    static constexpr size_t blockSize = 1024; /**< Количество символов, сдвигаемых ядром за один вызов. */
+    static constexpr size_t keyCacheSize = 256; /**< Сколько последних ключей хранит кэш расписаний. */
+
+    /**
+     * @brief Разобранный ключ: всё, что конструктор строит по строке ключа.
+     */
+    struct KeySchedule {
+        std::vector<int> key; /**< Ключ в числовом формате. */
+        std::vector<unsigned char> keyStream; /**< Ключ, развёрнутый на `key.size() + blockSize` позиций. */
+        std::vector<unsigned char> inverseKeyStream; /**< То же для расшифрования: размер алфавита минус ключ. */
+        Alphabet alphabet; /**< Алфавит (у алфавита времени компиляции — пустой тип). */
+        std::string utf8; /**< Буквы алфавита времени работы в UTF-8 по 4 байта. */
+        size_t utf8Width = 0; /**< Длина буквы алфавита времени работы в UTF-8 или 0, если она разная. */
+
+        explicit KeySchedule(const Alphabet& alphabet) : alphabet(alphabet) {}
+    };
+
+    std::shared_ptr<const KeySchedule> schedule; /**< Расписание ключа, общее для объектов с одинаковым ключом. */
+
+    /**
+     * @brief Строит расписание по строке ключа.
+     * 
+     * @param skey Ключ.
+     * @param alphabet Алфавит шифра.
+     * @return KeySchedule Расписание.
+     * @throws std::invalid_argument Если ключ содержит недопустимые символы.
+     */
+    static KeySchedule makeSchedule(const std::wstring& skey, const Alphabet& alphabet);
+
+    /**
+     * @brief Алфавит конструктора без алфавита: тип-тег или русский алфавит времени работы.
+     */
+    static Alphabet defaultAlphabet() {
+        if constexpr (runtimeAlphabet) {
+            return Alphabet::russian();
+        } else {
+            return Alphabet{};
+        }
+    }
+
+    /**
+     * @brief Вызывает `body` с таблицами алфавита расписания.
+     * 
+     * @details У алфавита времени компиляции это пустой FixedLetters, у объекта Alphabet —
+     * LoadedLetters с таблицей номеров, выбранной один раз на вызов (см. Alphabet::withLookup()).
+     * 
+     * @return Результат `body`.
+     */
+    template <class Body>
+    static decltype(auto) withLetters(const KeySchedule& schedule, Body&& body) {
+        if constexpr (runtimeAlphabet) {
+            return schedule.alphabet.withLookup([&](auto table) {
+                return body(LoadedLetters<decltype(table)>{schedule.alphabet, table, schedule.utf8.data(),
+                                                           schedule.utf8Width});
+            });
+        } else {
+            return body(FixedLetters<Alphabet>{});
+        }
+    }
 
     /**
      * @brief Преобразует строку в числовой вектор.
      * 
      * @param s Входная строка.
+     * @param letters Таблицы алфавита.
      * @return std::vector<int> Числовой вектор.
      * @throws std::invalid_argument Если строка содержит недопустимые символы.
      */
-    std::vector<int> convert(const std::wstring& s);
+    template <class Letters>
+    static std::vector<int> convert(const std::wstring& s, const Letters& letters);
+
+    /**
+     * @brief Проверяет символы, сдвигает их и записывает результат.
+     * 
+     * @details Текст обрабатывается блоками по `blockSize` символов: блок проверяется
+     * векторным сравнением с границами алфавита, номера символов собираются в буфер
+     * на стеке, сдвигаются векторным ядром (см. shiftKernel.h) и сразу переводятся
+     * обратно в символы. Блоки до недопустимого символа успевают записаться в `out`.
+     * 
+     * @param text Входные символы.
+     * @param length Количество символов.
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `text`).
+     * @param stream Развёрнутый поток сдвигов (`keyStream` или `inverseKeyStream`).
+     * @param phase Позиция ключа для первого символа.
+     * @return CipherResult Код результата, позиция ошибки и позиция ключа после текста.
+     */
+    CipherResult shift(const wchar_t* text, size_t length, wchar_t* out,
+                       const std::vector<unsigned char>& stream, size_t phase) const noexcept;
 
     /**
-     * @brief Преобразует числовой вектор обратно в строку.
+     * @brief То же, что shift(), но для пакета сообщений.
+     * 
+     * @details Символы всех сообщений собираются в общие блоки по `blockSize`,
+     * а сдвиги для блока копируются из `stream` отрезками, начиная позицию ключа
+     * заново с каждого сообщения (если задано `resetKey`). Так короткие сообщения
+     * обрабатываются одним вызовом векторного ядра на блок.
      * 
-     * @param v Числовой вектор.
-     * @return std::wstring Строка, восстановленная из числового вектора.
-     * @throws std::invalid_argument Если вектор содержит недопустимые индексы.
+     * @param resetKey true — ключ начинается заново в каждом сообщении,
+     * false — пакет шифруется как один сплошной текст.
+     */
+    void shiftBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out,
+                    const std::vector<unsigned char>& stream, bool resetKey) const;
+
+    /**
+     * @brief Сдвигает символы, стоящие в открытом тексте с постоянным шагом.
+     *
+     * @details Позиция в открытом тексте `start + k * stride` задаёт позицию ключа.
+     * При `gather` символ берётся из `text` на этой позиции и пишется в `out[k]`,
+     * иначе берётся из `text[k]` и пишется на эту позицию.
      */
-    std::wstring convert(const std::vector<int>& v);
+    template <bool gather>
+    void shiftStrided(const wchar_t* text, wchar_t* out, size_t start, size_t stride, size_t count,
+                      const std::vector<unsigned char>& stream) const;
+
+    /**
+     * @brief То же, что shift(), но над байтами UTF-8 без перевода в wchar_t.
+     * 
+     * @details Все буквы алфавита занимают в UTF-8 одинаковое число байт (от 1 до 4),
+     * поэтому результат имеет ту же длину и раскладку, что и вход.
+     * 
+     * @param text Входные байты.
+     * @param length Количество байт.
+     * @param out Буфер результата не меньше `length` байт (может совпадать с `text`).
+     * @param stream Развёрнутый поток сдвигов.
+     * @param phase Позиция ключа для первой буквы.
+     * @param keepSpaces true — пробельные символы (пробел, табуляция, перевод строки)
+     * копируются и не сдвигают ключ; false — считаются недопустимыми, как в std::wstring-интерфейсе.
+     * @return CipherResult Код результата, позиция ошибки в байтах и позиция ключа после текста.
+     */
+    CipherResult shiftUtf8(const char* text, size_t length, char* out,
+                           const std::vector<unsigned char>& stream, size_t phase,
+                           bool keepSpaces = true) const noexcept;
+
+    /**
+     * @brief Ядро shiftUtf8() для букв длины `width` байт.
+     */
+    template <size_t width, class Letters>
+    CipherResult shiftUtf8Letters(const Letters& letters, const char* text, size_t length, char* out,
+                                  const std::vector<unsigned char>& stream, size_t phase,
+                                  bool keepSpaces) const noexcept;
+
+    /**
+     * @brief То же, что shiftUtf8(), но блоки текста обрабатываются несколькими потоками.
+     * 
+     * @details Блок считает свои буквы, получает позицию ключа от предыдущего блока
+     * через BlockChain (см. parallel.h), передаёт следующему свою и шифруется, пока
+     * он ещё в кэше. Результат совпадает с последовательной обработкой.
+     * 
+     * @param threads Число потоков (0 — по числу ядер).
+     */
+    size_t shiftUtf8Parallel(const char* text, size_t length, char* out,
+                             const std::vector<unsigned char>& stream, size_t phase, unsigned threads) const;
+
+    /**
+     * @brief Обрабатывает файл целиком через отображение в память.
+     * 
+     * @param input Путь к входному файлу.
+     * @param output Путь к выходному файлу (создаётся того же размера).
+     * @param stream Развёрнутый поток сдвигов.
+     * @param threads Число потоков (0 — по числу ядер).
+     */
+    void shiftFile(const std::string& input, const std::string& output,
+                   const std::vector<unsigned char>& stream, unsigned threads) const;
 
 public:
-    modAlphaCipher() = delete; /**< Конструктор по умолчанию запрещен. */
+    BasicGronsfeld() = delete; /**< Конструктор по умолчанию запрещен. */
 
     /**
      * @brief Конструктор с ключом.
      * 
+     * @details Разобранные ключи хранятся в общем потокобезопасном кэше на `keyCacheSize`
+     * записей с вытеснением давно не использованных, поэтому повторный ключ не разбирается
+     * заново: объект получает готовое расписание.
+     * 
      * @param skey Ключ в виде строки.
      * @throws std::invalid_argument Если ключ пуст или содержит недопустимые символы.
      */
-    modAlphaCipher(const std::wstring& skey);
+    BasicGronsfeld(const std::wstring& skey);
+
+    /**
+     * @brief Конструктор с ключом и алфавитом.
+     * 
+     * @details Нужен для `runtimeGronsfeld`: ключ разбирается по заданному алфавиту,
+     * а кэш расписаний различает одинаковые ключи над разными алфавитами. Конструктор
+     * без алфавита у `runtimeGronsfeld` берёт русский алфавит (как у `modAlphaCipher`).
+     * 
+     * @param skey Ключ в виде строки.
+     * @param alphabet Алфавит шифра.
+     * @throws std::invalid_argument Если ключ пуст или содержит символы не из алфавита.
+     */
+    BasicGronsfeld(const std::wstring& skey, const Alphabet& alphabet);
+
+    /**
+     * @brief Алфавит шифра.
+     */
+    const Alphabet& getAlphabet() const { return schedule->alphabet; }
 
     /**
      * @brief Шифрует текст.
@@ -72,7 +271,7 @@ public:
      * @return std::wstring Зашифрованный текст.
      * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
      */
-    std::wstring encrypt(const std::wstring& open_text);
+    std::wstring encrypt(const std::wstring& open_text) const;
 
     /**
      * @brief Расшифровывает текст.
@@ -81,5 +280,400 @@ public:
      * @return std::wstring Расшифрованный текст.
      * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
      */
-    std::wstring decrypt(const std::wstring& cipher_text);
+    std::wstring decrypt(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Шифрует текст в UTF-8.
+     * 
+     * @details То же, что encrypt(const std::wstring&), но без перевода в wchar_t и обратно:
+     * буквы сдвигаются прямо как байты UTF-8.
+     * 
+     * @param open_text Текст для шифрования в UTF-8.
+     * @return std::string Зашифрованный текст в UTF-8.
+     * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
+     */
+    std::string encrypt(std::string_view open_text) const;
+
+    /**
+     * @brief Расшифровывает текст в UTF-8.
+     * 
+     * @param cipher_text Текст для расшифрования в UTF-8.
+     * @return std::string Расшифрованный текст в UTF-8.
+     * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
+     */
+    std::string decrypt(std::string_view cipher_text) const;
+
+    /**
+     * @brief Шифрует текст в буфер вызывающей стороны без выделения памяти.
+     * 
+     * @details Длинный текст можно обрабатывать частями, передавая в каждый
+     * следующий вызов позицию ключа, возвращённую предыдущим.
+     * 
+     * @param open_text Текст для шифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `open_text`).
+     * @param phase Позиция ключа для первого символа (берётся по модулю длины ключа).
+     * @return size_t Позиция ключа для символа, следующего за последним.
+     * @throws std::invalid_argument Если текст содержит недопустимые символы.
+     */
+    size_t encrypt(const wchar_t* open_text, size_t length, wchar_t* out, size_t phase = 0) const;
+
+    /**
+     * @brief Расшифровывает текст в буфер вызывающей стороны без выделения памяти.
+     * 
+     * @param cipher_text Текст для расшифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `cipher_text`).
+     * @param phase Позиция ключа для первого символа (берётся по модулю длины ключа).
+     * @return size_t Позиция ключа для символа, следующего за последним.
+     * @throws std::invalid_argument Если текст содержит недопустимые символы.
+     */
+    size_t decrypt(const wchar_t* cipher_text, size_t length, wchar_t* out, size_t phase = 0) const;
+
+    /**
+     * @brief Шифрует текст в буфер вызывающей стороны без исключений.
+     * 
+     * @details То же, что encrypt(const wchar_t*, size_t, wchar_t*, size_t), но недопустимый
+     * символ возвращается кодом результата: на потоке враждебного ввода не тратится время
+     * на раскрутку стека. Символы до блока с ошибкой могут быть уже записаны в `out`.
+     * 
+     * @param open_text Текст для шифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `open_text`).
+     * @param phase Позиция ключа для первого символа.
+     * @return CipherResult `ok` и позиция ключа после текста или `invalidCharacter` и позиция символа.
+     */
+    CipherResult tryEncrypt(const wchar_t* open_text, size_t length, wchar_t* out, size_t phase = 0) const noexcept;
+
+    /**
+     * @brief Расшифровывает текст в буфер вызывающей стороны без исключений.
+     * 
+     * @param cipher_text Текст для расшифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `cipher_text`).
+     * @param phase Позиция ключа для первого символа.
+     * @return CipherResult `ok` и позиция ключа после текста или `invalidCharacter` и позиция символа.
+     */
+    CipherResult tryDecrypt(const wchar_t* cipher_text, size_t length, wchar_t* out, size_t phase = 0) const noexcept;
+
+    /**
+     * @brief Шифрует символы, взятые из текста с постоянным шагом (сбор с подстановкой).
+     *
+     * @details `out[k]` — символ `open_text[start + k * stride]`, зашифрованный с той же
+     * позицией ключа, что и при шифровании всего текста. Столбец таблицы маршрутной
+     * перестановки — это как раз такой набор символов, поэтому подстановка
+     * и перестановка выполняются за один проход (см. product/productCipher.h).
+     *
+     * @param open_text Открытый текст.
+     * @param start Позиция первого символа.
+     * @param stride Шаг между символами.
+     * @param count Количество символов.
+     * @param out Буфер результата не меньше `count` символов (не совпадает с `open_text`).
+     * @throws std::invalid_argument Если среди взятых символов есть недопустимые.
+     */
+    void encryptStrided(const wchar_t* open_text, size_t start, size_t stride, size_t count, wchar_t* out) const;
+
+    /**
+     * @brief Расшифровывает символы и раскладывает их по тексту с постоянным шагом.
+     *
+     * @details Обратное к encryptStrided(): `cipher_text[k]` расшифровывается с позицией
+     * ключа `start + k * stride` и записывается в `out[start + k * stride]`.
+     *
+     * @param cipher_text Шифротекст (`count` символов).
+     * @param count Количество символов.
+     * @param out Открытый текст (не совпадает с `cipher_text`).
+     * @param start Позиция первого символа в `out`.
+     * @param stride Шаг между символами в `out`.
+     * @throws std::invalid_argument Если среди символов есть недопустимые.
+     */
+    void decryptStrided(const wchar_t* cipher_text, size_t count, wchar_t* out, size_t start, size_t stride) const;
+
+    /**
+     * @brief Шифрует пакет сообщений под одним ключом без выделения памяти на сообщение.
+     * 
+     * @details Сообщения лежат подряд в `text`, сообщение `i` занимает символы
+     * `[offsets[i], offsets[i + 1])`. Шифрование не меняет длину, поэтому результат
+     * каждого сообщения пишется в `out` по тем же смещениям. Пустые сообщения допускаются.
+     * 
+     * @param text Сообщения подряд.
+     * @param offsets Границы сообщений: `count + 1` неубывающих смещений.
+     * @param count Количество сообщений.
+     * @param out Буфер результата не меньше `offsets[count]` символов (может совпадать с `text`).
+     * @param resetKey true — ключ начинается заново в каждом сообщении,
+     * false — продолжается с места, где остановился в предыдущем.
+     * @throws std::invalid_argument Если какое-либо сообщение содержит недопустимые символы.
+     */
+    void encryptBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out,
+                      bool resetKey = true) const;
+
+    /**
+     * @brief Расшифровывает пакет сообщений под одним ключом без выделения памяти на сообщение.
+     * 
+     * @param text Сообщения подряд.
+     * @param offsets Границы сообщений: `count + 1` неубывающих смещений.
+     * @param count Количество сообщений.
+     * @param out Буфер результата не меньше `offsets[count]` символов (может совпадать с `text`).
+     * @param resetKey Должен совпадать со значением, использованным при шифровании.
+     * @throws std::invalid_argument Если какое-либо сообщение содержит недопустимые символы.
+     */
+    void decryptBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out,
+                      bool resetKey = true) const;
+
+    /**
+     * @brief Шифрует пакет сообщений и возвращает результат одним пакетом.
+     * 
+     * @param batch Пакет сообщений.
+     * @param resetKey true — ключ начинается заново в каждом сообщении.
+     * @return MessageBatch Зашифрованные сообщения с теми же смещениями.
+     * @throws std::invalid_argument Если смещения не согласованы с текстом или сообщение содержит недопустимые символы.
+     */
+    MessageBatch encryptBatch(const MessageBatch& batch, bool resetKey = true) const;
+
+    /**
+     * @brief Расшифровывает пакет сообщений и возвращает результат одним пакетом.
+     * 
+     * @param batch Пакет сообщений.
+     * @param resetKey Должен совпадать со значением, использованным при шифровании.
+     * @return MessageBatch Расшифрованные сообщения с теми же смещениями.
+     * @throws std::invalid_argument Если смещения не согласованы с текстом или сообщение содержит недопустимые символы.
+     */
+    MessageBatch decryptBatch(const MessageBatch& batch, bool resetKey = true) const;
+
+    /**
+     * @brief Шифрует текст в UTF-8 без перевода в wchar_t.
+     * 
+     * @details Пробельные символы копируются без изменений и не сдвигают ключ.
+     * Результат имеет ту же длину в байтах, что и вход.
+     * 
+     * @param open_text Байты UTF-8.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `length` байт (может совпадать с `open_text`).
+     * @param phase Позиция ключа для первой буквы.
+     * @return size_t Позиция ключа для буквы, следующей за последней.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы или обрывается посреди буквы.
+     */
+    size_t encrypt(const char* open_text, size_t length, char* out, size_t phase = 0) const;
+
+    /**
+     * @brief Расшифровывает текст в UTF-8 без перевода в wchar_t.
+     * 
+     * @param cipher_text Байты UTF-8.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `length` байт (может совпадать с `cipher_text`).
+     * @param phase Позиция ключа для первой буквы.
+     * @return size_t Позиция ключа для буквы, следующей за последней.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы или обрывается посреди буквы.
+     */
+    size_t decrypt(const char* cipher_text, size_t length, char* out, size_t phase = 0) const;
+
+    /**
+     * @brief Шифрует текст в UTF-8 без исключений.
+     * 
+     * @details То же, что encrypt(const char*, size_t, char*, size_t), но ошибка возвращается
+     * кодом результата с позицией первого байта недопустимого символа.
+     * 
+     * @param open_text Байты UTF-8.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `length` байт (может совпадать с `open_text`).
+     * @param phase Позиция ключа для первой буквы.
+     * @return CipherResult Код результата, позиция ошибки и позиция ключа после текста.
+     */
+    CipherResult tryEncrypt(const char* open_text, size_t length, char* out, size_t phase = 0) const noexcept;
+
+    /**
+     * @brief Расшифровывает текст в UTF-8 без исключений.
+     * 
+     * @param cipher_text Байты UTF-8.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `length` байт (может совпадать с `cipher_text`).
+     * @param phase Позиция ключа для первой буквы.
+     * @return CipherResult Код результата, позиция ошибки и позиция ключа после текста.
+     */
+    CipherResult tryDecrypt(const char* cipher_text, size_t length, char* out, size_t phase = 0) const noexcept;
+
+    /**
+     * @brief Шифрует текст в UTF-8 на нескольких потоках.
+     * 
+     * @details Результат побайтно совпадает с encrypt(const char*, size_t, char*, size_t).
+     * Короткие тексты обрабатываются в вызывающем потоке.
+     * 
+     * @param open_text Байты UTF-8.
+     * @param length Количество байт.
+     * @param out Буфер результата не меньше `length` байт (может совпадать с `open_text`).
+     * @param threads Число потоков (0 — по числу ядер).
+     * @param phase Позиция ключа для первой буквы.
+     * @return size_t Позиция ключа для буквы, следующей за последней.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы.
+     */
+    size_t encryptParallel(const char* open_text, size_t length, char* out, unsigned threads,
+                           size_t phase = 0) const;
+
+    /**
+     * @brief Расшифровывает текст в UTF-8 на нескольких потоках.
+     * 
+     * @param cipher_text Байты UTF-8.
+     * @param length Количество байт.
+     * @param out Буфер результата не меньше `length` байт (может совпадать с `cipher_text`).
+     * @param threads Число потоков (0 — по числу ядер).
+     * @param phase Позиция ключа для первой буквы.
+     * @return size_t Позиция ключа для буквы, следующей за последней.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы.
+     */
+    size_t decryptParallel(const char* cipher_text, size_t length, char* out, unsigned threads,
+                           size_t phase = 0) const;
+
+    /**
+     * @brief Шифрует файл в UTF-8, отображая вход и выход в память.
+     * 
+     * @details Текст не копируется в std::wstring: буквы обрабатываются прямо
+     * как байты UTF-8, результат пишется в отображение временного файла, который
+     * заменяет выходной после успешной обработки. Выходной файл может совпадать
+     * с входным; при ошибке он не изменяется.
+     * 
+     * @param input Путь к входному файлу.
+     * @param output Путь к выходному файлу.
+     * @param threads Число потоков (0 — по числу ядер).
+     * @throws std::invalid_argument Если файл содержит недопустимые символы.
+     * @throws std::runtime_error Если файл не удалось открыть, создать или отобразить.
+     */
+    void encryptFile(const std::string& input, const std::string& output, unsigned threads = 1) const;
+
+    /**
+     * @brief Расшифровывает файл в UTF-8, отображая вход и выход в память.
+     * 
+     * @param input Путь к входному файлу.
+     * @param output Путь к выходному файлу.
+     * @param threads Число потоков (0 — по числу ядер).
+     * @throws std::invalid_argument Если файл содержит недопустимые символы.
+     * @throws std::runtime_error Если файл не удалось открыть, создать или отобразить.
+     */
+    void decryptFile(const std::string& input, const std::string& output, unsigned threads = 1) const;
 };
+
+/**
+ * @brief Потоковый контекст шифра: обрабатывает текст фрагментами произвольной длины.
+ *
+ * @details Объявлен для всех шифров; реализация — специализация для конкретного шифра.
+ */
+template <class Cipher>
+class CipherStream;
+
+/**
+ * @class CipherStream<BasicGronsfeld<Alphabet>>
+ * @brief Шифрование или расшифрование потока фрагментов с сохранением позиции ключа.
+ * 
+ * @details Позиция ключа переносится между вызовами update(), поэтому текст,
+ * поданный любыми фрагментами, даёт тот же результат, что и один вызов над всем
+ * текстом. Шифр Гронсвельда не меняет длину текста, поэтому каждый фрагмент
+ * возвращается сразу, а finalize() ничего не дописывает: он проверяет, что в UTF-8
+ * не осталось оборванной буквы, и готовит контекст к следующему сообщению.
+ * 
+ * Во фрагментах UTF-8 буква может разорваться границей фрагмента: её начало
+ * хранится в контексте до следующего вызова. Пробельные символы в UTF-8 копируются
+ * и не сдвигают ключ, как в encrypt(const char*, size_t, char*, size_t).
+ * 
+ * @tparam Alphabet Тип алфавита шифра.
+ */
+template <class Alphabet>
+class CipherStream<BasicGronsfeld<Alphabet>> {
+private:
+    BasicGronsfeld<Alphabet> cipher; /**< Копия шифра (расписание ключа общее с исходным объектом). */
+    bool forward;                    /**< true — шифрование, false — расшифрование. */
+    size_t phase = 0;                /**< Позиция ключа для следующего символа. */
+    char carry[3] = {};              /**< Начало буквы UTF-8, оборванной концом фрагмента. */
+    size_t carried = 0;              /**< Сколько байт в `carry` (0 — оборванной буквы нет). */
+
+    /**
+     * @brief Обрабатывает целые буквы UTF-8 начиная с позиции ключа `from`.
+     *
+     * @return size_t Позиция ключа после фрагмента.
+     */
+    size_t shiftUtf8(const char* in, size_t length, char* out, size_t from) const;
+
+public:
+    /**
+     * @brief Создаёт контекст для одного направления.
+     * 
+     * @param cipher Шифр с установленным ключом.
+     * @param forward true — шифрование, false — расшифрование.
+     */
+    CipherStream(const BasicGronsfeld<Alphabet>& cipher, bool forward);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент.
+     * 
+     * @param in Символы фрагмента.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `in`).
+     * @return size_t Количество записанных символов (равно `length`).
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы;
+     * позиция ключа при этом не меняется.
+     */
+    size_t update(const wchar_t* in, size_t length, wchar_t* out);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент.
+     * 
+     * @param fragment Фрагмент текста.
+     * @return std::wstring Результат той же длины.
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы;
+     * позиция ключа при этом не меняется.
+     */
+    std::wstring update(const std::wstring& fragment);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент в UTF-8.
+     * 
+     * @param in Байты фрагмента.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `length + 3` байт (не может совпадать с `in`).
+     * @return size_t Количество записанных байт: оборванная в конце буква ждёт следующего фрагмента.
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы
+     * или буквы алфавита имеют разную длину в UTF-8; позиция ключа и оборванная буква
+     * предыдущего фрагмента при этом не меняются, а содержимое `out` не определено.
+     */
+    size_t update(const char* in, size_t length, char* out);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент в UTF-8.
+     * 
+     * @param fragment Байты фрагмента.
+     * @return std::string Результат для всех целых букв фрагмента.
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы;
+     * состояние контекста при этом не меняется.
+     */
+    std::string update(std::string_view fragment);
+
+    /**
+     * @brief Количество символов, которое допишет finalize() (у шифра Гронсвельда всегда 0).
+     */
+    size_t pending() const { return 0; }
+
+    /**
+     * @brief Завершает сообщение и готовит контекст к следующему (ключ с начала).
+     * 
+     * @param out Не используется: шифр Гронсвельда выдаёт результат сразу в update().
+     * @return size_t Количество записанных символов (0).
+     * @throws std::invalid_argument Если поток UTF-8 оборвался посреди буквы.
+     */
+    size_t finalize(wchar_t* out = nullptr);
+
+    /**
+     * @brief Позиция ключа для следующего символа.
+     */
+    size_t keyPhase() const { return phase; }
+};
+
+using modAlphaCipher = BasicGronsfeld<RussianAlphabet>;   /**< Шифр над русским алфавитом (33 буквы). */
+using latinGronsfeld = BasicGronsfeld<LatinAlphabet>;     /**< Шифр над латинским алфавитом (26 букв). */
+using combinedGronsfeld = BasicGronsfeld<CombinedAlphabet>; /**< Шифр над русским и латинским алфавитами (59 букв). */
+using runtimeGronsfeld = BasicGronsfeld<Alphabet>;        /**< Шифр над алфавитом, заданным во время работы. */
+
+extern template class BasicGronsfeld<RussianAlphabet>;
+extern template class BasicGronsfeld<LatinAlphabet>;
+extern template class BasicGronsfeld<CombinedAlphabet>;
+extern template class BasicGronsfeld<Alphabet>;
+extern template class CipherStream<BasicGronsfeld<RussianAlphabet>>;
+extern template class CipherStream<BasicGronsfeld<LatinAlphabet>>;
+extern template class CipherStream<BasicGronsfeld<CombinedAlphabet>>;
+extern template class CipherStream<BasicGronsfeld<Alphabet>>;
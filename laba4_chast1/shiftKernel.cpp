@@ -0,0 +1,120 @@
+/**
+ * @file shiftKernel.cpp
+ * @brief Реализации ядра сдвига индексов и выбор реализации по CPUID.
+ *
+ * @details
+ * Векторные варианты считают `a + k`, если `a < modulus - k`, и `a - (modulus - k)` иначе.
+ * Обе ветви остаются в диапазоне байта при любом `modulus <= 256`, поэтому
+ * переполнения нет, а результат совпадает со скалярным `(a + k) mod modulus`.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "shiftKernel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SHIFT_KERNEL_X86 1
+#endif
+
+namespace {
+
+void shiftScalar(const unsigned char* text, const unsigned char* keyStream, size_t length,
+                 unsigned modulus, unsigned char* out) {
+    for (size_t i = 0; i < length; i++) {
+        unsigned sum = text[i] + keyStream[i];
+        if (sum >= modulus) {
+            sum -= modulus;
+        }
+        out[i] = static_cast<unsigned char>(sum);
+    }
+}
+
+#ifdef SHIFT_KERNEL_X86
+
+__attribute__((target("sse4.2")))
+void shiftSse42(const unsigned char* text, const unsigned char* keyStream, size_t length,
+                unsigned modulus, unsigned char* out) {
+    const __m128i m = _mm_set1_epi8(static_cast<char>(modulus));
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        const __m128i k = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keyStream + i));
+        const __m128i rest = _mm_sub_epi8(m, k);
+        const __m128i wrap = _mm_cmpeq_epi8(_mm_max_epu8(a, rest), a);
+        const __m128i r = _mm_blendv_epi8(_mm_add_epi8(a, k), _mm_sub_epi8(a, rest), wrap);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), r);
+    }
+    shiftScalar(text + i, keyStream + i, length - i, modulus, out + i);
+}
+
+__attribute__((target("avx2")))
+void shiftAvx2(const unsigned char* text, const unsigned char* keyStream, size_t length,
+               unsigned modulus, unsigned char* out) {
+    const __m256i m = _mm256_set1_epi8(static_cast<char>(modulus));
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keyStream + i));
+        const __m256i rest = _mm256_sub_epi8(m, k);
+        const __m256i wrap = _mm256_cmpeq_epi8(_mm256_max_epu8(a, rest), a);
+        const __m256i r = _mm256_blendv_epi8(_mm256_add_epi8(a, k), _mm256_sub_epi8(a, rest), wrap);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+    }
+    // Хвост обрабатывается SSE-кодом без VEX-префикса: без очистки верхних половин
+    // регистров каждый вызов платит за переход между режимами AVX и SSE.
+    _mm256_zeroupper();
+    shiftSse42(text + i, keyStream + i, length - i, modulus, out + i);
+}
+
+#endif
+
+} // namespace
+
+ShiftKernel detectShiftKernel() {
+#ifdef SHIFT_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ShiftKernel::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return ShiftKernel::sse42;
+    }
+#endif
+    return ShiftKernel::scalar;
+}
+
+const char* shiftKernelName(ShiftKernel kernel) {
+    switch (kernel) {
+    case ShiftKernel::avx2:
+        return "avx2";
+    case ShiftKernel::sse42:
+        return "sse4.2";
+    default:
+        return "scalar";
+    }
+}
+
+void shiftIndices(ShiftKernel kernel, const unsigned char* text, const unsigned char* keyStream,
+                  size_t length, unsigned modulus, unsigned char* out) {
+    switch (kernel) {
+#ifdef SHIFT_KERNEL_X86
+    case ShiftKernel::avx2:
+        shiftAvx2(text, keyStream, length, modulus, out);
+        break;
+    case ShiftKernel::sse42:
+        shiftSse42(text, keyStream, length, modulus, out);
+        break;
+#endif
+    default:
+        shiftScalar(text, keyStream, length, modulus, out);
+        break;
+    }
+}
+
+void shiftIndices(const unsigned char* text, const unsigned char* keyStream, size_t length,
+                  unsigned modulus, unsigned char* out) {
+    static const ShiftKernel kernel = detectShiftKernel();
+    shiftIndices(kernel, text, keyStream, length, modulus, out);
+}
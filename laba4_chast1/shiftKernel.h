@@ -0,0 +1,57 @@
+/**
+ * @file shiftKernel.h
+ * @brief Векторное ядро сдвига индексов алфавита для шифра Гронсвельда.
+ *
+ * Ядро работает с номерами символов в алфавите (по одному байту на символ)
+ * и заранее развёрнутым потоком ключа: `out[i] = (text[i] + keyStream[i]) mod modulus`.
+ * Остаток берётся условным вычитанием, без деления.
+ *
+ * @details
+ * Реализация выбирается при первом вызове по результату CPUID:
+ * AVX2, SSE4.2 или скалярный вариант. Все варианты дают побитно одинаковый результат.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <cstddef>
+
+/**
+ * @brief Доступные реализации ядра сдвига.
+ */
+enum class ShiftKernel {
+    scalar, /**< Переносимый скалярный цикл. */
+    sse42,  /**< 16 символов за итерацию (SSE4.2). */
+    avx2    /**< 32 символа за итерацию (AVX2). */
+};
+
+/**
+ * @brief Сдвигает индексы лучшей реализацией, поддерживаемой процессором.
+ *
+ * @param text Номера символов, каждый меньше `modulus`.
+ * @param keyStream Сдвиги для каждой позиции, каждый меньше `modulus`.
+ * @param length Количество символов.
+ * @param modulus Размер алфавита (не больше 256).
+ * @param out Буфер результата (может совпадать с `text`).
+ */
+void shiftIndices(const unsigned char* text, const unsigned char* keyStream, size_t length,
+                  unsigned modulus, unsigned char* out);
+
+/**
+ * @brief Сдвигает индексы заданной реализацией.
+ *
+ * @details Нужна для тестов и замеров; реализация должна поддерживаться процессором.
+ */
+void shiftIndices(ShiftKernel kernel, const unsigned char* text, const unsigned char* keyStream,
+                  size_t length, unsigned modulus, unsigned char* out);
+
+/**
+ * @brief Возвращает реализацию, выбранную по CPUID.
+ */
+ShiftKernel detectShiftKernel();
+
+/**
+ * @brief Возвращает название реализации ("scalar", "sse4.2", "avx2").
+ */
+const char* shiftKernelName(ShiftKernel kernel);
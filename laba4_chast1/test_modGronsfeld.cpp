@@ -0,0 +1,576 @@
+#include <UnitTest++/UnitTest++.h>
+#include "modGronsfeld.h"
+#include "gronsfeldCrack.h"
+#include "shiftKernel.h"
+#include "../common/metrics.h"
+#include "../common/russianFrequencies.h"
+#include "../common/pipeline.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <thread>
+
+TEST(TestConstructorValidKey) {
+    modAlphaCipher cipher(L"БКД");
+}
+
+TEST(TestConstructorInvalidKeyLowerCase) {
+    CHECK_THROW(modAlphaCipher(L"бкд"), std::invalid_argument);
+}
+
+TEST(TestConstructorEmptyKey) {
+    CHECK_THROW(modAlphaCipher(L""), std::invalid_argument);
+}
+
+TEST(TestConstructorInvalidKeyWithDigits) {
+    CHECK_THROW(modAlphaCipher(L"123"), std::invalid_argument);
+}
+
+TEST(TestEncryptEmptyText) {
+    modAlphaCipher cipher(L"БКД");
+    CHECK_THROW(cipher.encrypt(L""), std::invalid_argument);
+}
+
+TEST(TestEncryptTextWithLowerCase) {
+    modAlphaCipher cipher(L"БКД");
+    CHECK_THROW(cipher.encrypt(L"бгеж"), std::invalid_argument);
+}
+
+TEST(TestEncryptTextWithForeignCharacters) {
+    modAlphaCipher cipher(L"БКД");
+    CHECK_THROW(cipher.encrypt(L"Hello"), std::invalid_argument);
+}
+
+TEST(TestEncryptValidText) {
+    modAlphaCipher cipher(L"БКД");
+    CHECK(cipher.encrypt(L"БГЕЖ") == L"ВНИЗ");
+}
+
+TEST(TestDecryptionCorrectness) {
+    modAlphaCipher cipher(L"БКД");
+    CHECK(cipher.decrypt(L"ВНИЗ") == L"БГЕЖ");
+}
+
+TEST(TestEncryptWrapsAroundAlphabet) {
+    modAlphaCipher cipher(L"Я");
+    CHECK(cipher.encrypt(L"АБЯ") == L"ЯАЮ");
+    CHECK(cipher.decrypt(L"ЯАЮ") == L"АБЯ");
+}
+
+TEST(TestEncryptIntoBuffer) {
+    modAlphaCipher cipher(L"БКД");
+    std::wstring out(4, L'\0');
+    cipher.encrypt(L"БГЕЖ", 4, &out[0]);
+    CHECK(out == L"ВНИЗ");
+    cipher.decrypt(out.data(), out.size(), &out[0]);
+    CHECK(out == L"БГЕЖ");
+}
+
+TEST(TestLongTextRoundTrip) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::mt19937 gen(1);
+    std::wstring text(5000, L' ');
+    for (auto& c : text) {
+        c = alphabet[gen() % alphabet.size()];
+    }
+    modAlphaCipher cipher(L"ЁЖИКЯЮЩ");
+    std::wstring encrypted = cipher.encrypt(text);
+    for (size_t i = 0; i < text.size(); i++) {
+        CHECK(encrypted[i] == alphabet[(alphabet.find(text[i]) + alphabet.find(L"ЁЖИКЯЮЩ"[i % 7])) % 33]);
+    }
+    CHECK(cipher.decrypt(encrypted) == text);
+}
+
+TEST(TestShiftKernelsMatchScalar) {
+    std::mt19937 gen(2);
+    for (unsigned modulus : {2u, 33u, 59u, 128u, 200u, 256u}) {
+        std::vector<unsigned char> text(1000), stream(1000);
+        for (size_t i = 0; i < text.size(); i++) {
+            text[i] = static_cast<unsigned char>(gen() % modulus);
+            stream[i] = static_cast<unsigned char>(gen() % modulus);
+        }
+        std::vector<unsigned char> expected(text.size());
+        shiftIndices(ShiftKernel::scalar, text.data(), stream.data(), text.size(), modulus, expected.data());
+        for (ShiftKernel kernel : {ShiftKernel::sse42, ShiftKernel::avx2}) {
+            if (static_cast<int>(kernel) > static_cast<int>(detectShiftKernel())) {
+                continue;
+            }
+            std::vector<unsigned char> actual(text.size());
+            shiftIndices(kernel, text.data(), stream.data(), text.size(), modulus, actual.data());
+            CHECK(actual == expected);
+        }
+    }
+}
+
+TEST(TestFindOutsideKernelsMatchScalar) {
+    using Tables = AlphabetTables<CombinedAlphabet>;
+    CHECK_EQUAL(Tables::rangeCount, 3u);
+    CHECK_EQUAL(AlphabetTables<RussianAlphabet>::rangeCount, 2u);
+    std::mt19937 gen(3);
+    const wchar_t foreign[] = {L'a', L'0', L'Ѐ', L'Ђ', L'а', L'@', L'[', static_cast<wchar_t>(0x7FFFFFFF)};
+    for (size_t length : {0u, 1u, 15u, 16u, 33u, 100u, 1000u}) {
+        std::wstring text(length, L' ');
+        for (auto& c : text) {
+            c = Tables::letters[gen() % Tables::size];
+        }
+        for (size_t bad = 0; bad <= length; bad += 1 + length / 10) {
+            std::wstring probe = text;
+            if (bad < length) {
+                probe[bad] = foreign[gen() % (sizeof(foreign) / sizeof(foreign[0]))];
+            }
+            const size_t expected = findOutside(ValidatorKernel::scalar, probe.data(), length, Tables::ranges.data(),
+                                                Tables::rangeCount);
+            CHECK_EQUAL(expected, bad < length ? bad : length);
+            for (ValidatorKernel kernel : {ValidatorKernel::sse42, ValidatorKernel::avx2}) {
+                if (static_cast<int>(kernel) > static_cast<int>(detectValidatorKernel())) {
+                    continue;
+                }
+                CHECK_EQUAL(findOutside(kernel, probe.data(), length, Tables::ranges.data(), Tables::rangeCount),
+                            expected);
+            }
+        }
+    }
+}
+
+TEST(TestSharedRangesMatchAlphabets) {
+    for (wchar_t c = 0; c < 0x10000; c++) {
+        const std::wstring one(1, c);
+        CHECK_EQUAL(isValidText(one, cyrillicUpper), RussianAlphabet::letters.find(c) != std::wstring_view::npos);
+        CHECK_EQUAL(isValidText(one, latinUpper), LatinAlphabet::letters.find(c) != std::wstring_view::npos);
+        CHECK_EQUAL(isValidText(one, cyrillicLatinUpper),
+                    CombinedAlphabet::letters.find(c) != std::wstring_view::npos);
+    }
+}
+
+TEST(TestTryEncryptReportsOffset) {
+    modAlphaCipher cipher(L"БКД");
+    std::wstring text(3000, L'Б');
+    std::wstring out(text.size(), L'\0');
+    CipherResult result = cipher.tryEncrypt(text.data(), text.size(), &out[0]);
+    CHECK(result);
+    CHECK_EQUAL(result.phase, 0u);
+    CHECK(out == cipher.encrypt(text));
+
+    text[2500] = L'б';
+    result = cipher.tryEncrypt(text.data(), text.size(), &out[0]);
+    CHECK(result.status == CipherStatus::invalidCharacter);
+    CHECK_EQUAL(result.offset, 2500u);
+    result = cipher.tryDecrypt(L"ВН1З", 4, &out[0]);
+    CHECK(result.status == CipherStatus::invalidCharacter);
+    CHECK_EQUAL(result.offset, 2u);
+}
+
+TEST(TestTryEncryptUtf8) {
+    modAlphaCipher cipher(L"БКД");
+    std::string out(16, '\0');
+    CipherResult result = cipher.tryEncrypt("БГ ЕЖ", 9, &out[0]);
+    CHECK(result);
+    CHECK_EQUAL(result.phase, 1u);
+    CHECK_EQUAL(out.substr(0, 9), std::string("ВН ИЗ"));
+    result = cipher.tryDecrypt("БГ Еж", 9, &out[0]);
+    CHECK(result.status == CipherStatus::invalidCharacter);
+    CHECK_EQUAL(result.offset, 7u);
+    result = combinedGronsfeld(L"A").tryEncrypt("A", 1, &out[0]);
+    CHECK(result.status == CipherStatus::unsupportedAlphabet);
+}
+
+TEST(TestEncryptUtf8KeepsSpaces) {
+    modAlphaCipher cipher(L"БКД");
+    const std::string text = "БГ\nЕЖ";
+    std::string out(text.size(), '\0');
+    CHECK_EQUAL(cipher.encrypt(text.data(), text.size(), &out[0]), 1u);
+    CHECK_EQUAL(out, std::string("ВН\nИЗ"));
+    cipher.decrypt(out.data(), out.size(), &out[0]);
+    CHECK_EQUAL(out, text);
+}
+
+TEST(TestEncryptUtf8Chunked) {
+    modAlphaCipher cipher(L"БКД");
+    std::string out = "БГЕЖ";
+    size_t phase = cipher.encrypt(out.data(), 2, &out[0]);
+    cipher.encrypt(out.data() + 2, 6, &out[2], phase);
+    CHECK_EQUAL(out, std::string("ВНИЗ"));
+}
+
+TEST(TestCipherStreamMatchesWholeText) {
+    const std::wstring letters = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::mt19937 gen(18);
+    std::wstring text(5000, L' ');
+    for (auto& c : text) {
+        c = letters[gen() % letters.size()];
+    }
+    const modAlphaCipher cipher(L"ШИФРОВАНИЕ");
+    const std::wstring expected = cipher.encrypt(text);
+    CipherStream<modAlphaCipher> encryptor(cipher, true);
+    CipherStream<modAlphaCipher> decryptor(cipher, false);
+    std::wstring encrypted;
+    std::wstring decrypted;
+    for (size_t pos = 0; pos < text.size();) {
+        const size_t n = std::min<size_t>(gen() % 40, text.size() - pos);
+        encrypted += encryptor.update(text.substr(pos, n));
+        decrypted += decryptor.update(expected.substr(pos, n));
+        pos += n;
+    }
+    CHECK_EQUAL(encryptor.finalize(), 0u);
+    CHECK(encrypted == expected);
+    CHECK(decrypted == text);
+    CHECK_EQUAL(encryptor.keyPhase(), 0u);
+    CHECK(encryptor.update(text.substr(0, 10)) == expected.substr(0, 10));
+
+    // Фрагменты UTF-8 режутся по любому байту, в том числе посреди буквы.
+    const std::string open = "БГ ЕЖ\nБГЕЖ";
+    std::string bytes(open.size(), '\0');
+    cipher.encrypt(open.data(), open.size(), &bytes[0]);
+    CipherStream<modAlphaCipher> utf8(cipher, false);
+    std::string back;
+    for (size_t pos = 0; pos < bytes.size(); pos += 3) {
+        back += utf8.update(std::string_view(bytes).substr(pos, 3));
+    }
+    utf8.finalize();
+    CHECK_EQUAL(back, open);
+    utf8.update(std::string_view("Б\xD0"));
+    CHECK_THROW(utf8.finalize(), std::invalid_argument);
+    CHECK_THROW(encryptor.update(L"Бк"), std::invalid_argument);
+
+    // Ошибка во фрагменте не сдвигает ключ и не теряет оборванную букву предыдущего фрагмента.
+    CipherStream<modAlphaCipher> resumed(cipher, false);
+    CHECK_EQUAL(resumed.update(std::string_view(bytes).substr(0, 3)), open.substr(0, 2));
+    CHECK_THROW(resumed.update(std::string_view(bytes.substr(3, 1) + "x")), std::invalid_argument);
+    CHECK_EQUAL(resumed.keyPhase(), 1u);
+    CHECK_EQUAL(resumed.update(std::string_view(bytes).substr(3)), open.substr(2));
+    CHECK_EQUAL(resumed.finalize(), 0u);
+}
+
+TEST(TestEncryptUtf8InvalidText) {
+    modAlphaCipher cipher(L"БКД");
+    std::string out(8, '\0');
+    CHECK_THROW(cipher.encrypt("Hello", 5, &out[0]), std::invalid_argument);
+    CHECK_THROW(cipher.encrypt("бг", 4, &out[0]), std::invalid_argument);
+    CHECK_THROW(cipher.encrypt("Б\xD0", 3, &out[0]), std::invalid_argument);
+}
+
+TEST(TestEncryptFile) {
+    modAlphaCipher cipher(L"БКД");
+    std::ofstream("test_input.txt") << "БГЕЖ БГЕЖ\n";
+    cipher.encryptFile("test_input.txt", "test_output.txt");
+    std::ifstream result("test_output.txt");
+    std::string text((std::istreambuf_iterator<char>(result)), std::istreambuf_iterator<char>());
+    CHECK_EQUAL(text, std::string("ВНИЗ ЛЖЁС\n"));
+    std::remove("test_input.txt");
+    std::remove("test_output.txt");
+}
+
+TEST(TestEncryptFileInPlace) {
+    modAlphaCipher cipher(L"БКД");
+    std::ofstream("test_inplace.txt") << "БГЕЖ БГЕЖ\n";
+    cipher.encryptFile("test_inplace.txt", "test_inplace.txt");
+    {
+        std::ifstream result("test_inplace.txt");
+        std::string text((std::istreambuf_iterator<char>(result)), std::istreambuf_iterator<char>());
+        CHECK_EQUAL(text, std::string("ВНИЗ ЛЖЁС\n"));
+    }
+    // При ошибке выходной файл остаётся прежним.
+    std::ofstream("test_input.txt") << "БГЕЖ hello\n";
+    CHECK_THROW(cipher.encryptFile("test_input.txt", "test_inplace.txt"), std::invalid_argument);
+    std::ifstream result("test_inplace.txt");
+    std::string text((std::istreambuf_iterator<char>(result)), std::istreambuf_iterator<char>());
+    CHECK_EQUAL(text, std::string("ВНИЗ ЛЖЁС\n"));
+    std::remove("test_input.txt");
+    std::remove("test_inplace.txt");
+}
+
+TEST(TestPipelineMatchesWholeText) {
+    modAlphaCipher cipher(L"БКД");
+    const std::string text = "БГЕЖ БГЕЖ\nЁЖИК";
+    std::string expected(text.size(), '\0');
+    cipher.encrypt(text.data(), text.size(), &expected[0]);
+    // Блок в 1 байт получает только первый байт буквы, блок в 7 байт режет буквы пополам.
+    for (size_t blockSize : {1, 7, 1024}) {
+        std::FILE* in = std::tmpfile();
+        std::FILE* out = std::tmpfile();
+        std::fwrite(text.data(), 1, text.size(), in);
+        std::rewind(in);
+        size_t phase = 0;
+        auto transform = [&](const char* block, size_t length, char* result) {
+            phase = cipher.encrypt(block, length, result, phase);
+            return length;
+        };
+        const PipelineTiming timing = runPipeline(in, out, blockSize, 1, transform, "read", "write");
+        CHECK_EQUAL(timing.bytesIn, text.size());
+        CHECK_EQUAL(timing.bytesOut, text.size());
+        std::rewind(out);
+        std::string result(text.size(), '\0');
+        CHECK_EQUAL(std::fread(&result[0], 1, result.size(), out), result.size());
+        CHECK_EQUAL(result, expected);
+        std::fclose(in);
+        std::fclose(out);
+    }
+    std::FILE* in = std::tmpfile();
+    std::FILE* out = std::tmpfile();
+    std::fwrite("БГ\xD0", 1, 5, in);
+    std::rewind(in);
+    auto transform = [&](const char* block, size_t length, char* result) {
+        cipher.encrypt(block, length, result);
+        return length;
+    };
+    CHECK_THROW(runPipeline(in, out, 2, 1, transform, "read", "write"), std::invalid_argument);
+    std::fclose(in);
+    std::fclose(out);
+}
+
+TEST(TestEncryptUtf8String) {
+    modAlphaCipher cipher(L"БКД");
+    CHECK_EQUAL(cipher.encrypt(std::string_view("БГЕЖ")), std::string("ВНИЗ"));
+    CHECK_EQUAL(cipher.decrypt(std::string_view("ВНИЗ")), std::string("БГЕЖ"));
+    CHECK_THROW(cipher.encrypt(std::string_view("")), std::invalid_argument);
+    CHECK_THROW(cipher.encrypt(std::string_view("БГ ЕЖ")), std::invalid_argument);
+}
+
+TEST(TestEncryptParallelMatchesSerial) {
+    const std::string letters[] = {"А", "Ё", "Я", "Ж", "П", "Р", " ", "\n"};
+    std::mt19937 gen(3);
+    std::string text;
+    while (text.size() < 1000000) {
+        text += letters[gen() % 8];
+    }
+    modAlphaCipher cipher(L"ЁЖИКЯЮЩ");
+    std::string serial(text.size(), '\0');
+    std::string parallel(text.size(), '\0');
+    const size_t serialPhase = cipher.encrypt(text.data(), text.size(), &serial[0], 3);
+    const size_t parallelPhase = cipher.encryptParallel(text.data(), text.size(), &parallel[0], 6, 3);
+    CHECK(parallel == serial);
+    CHECK_EQUAL(parallelPhase, serialPhase);
+    cipher.decryptParallel(parallel.data(), parallel.size(), &parallel[0], 5, 3);
+    CHECK(parallel == text);
+    // Ошибка в одном из последних блоков не должна оставлять ждущие потоки.
+    text[900001] = 'x';
+    CHECK_THROW(cipher.encryptParallel(text.data(), text.size(), &parallel[0], 6, 3), std::invalid_argument);
+}
+
+TEST(TestEncryptBatchMatchesSingleMessages) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::mt19937 gen(5);
+    MessageBatch batch;
+    std::vector<std::wstring> messages;
+    batch.offsets.push_back(0);
+    for (int m = 0; m < 300; m++) {
+        std::wstring message(gen() % 40, L' ');
+        for (auto& c : message) {
+            c = alphabet[gen() % alphabet.size()];
+        }
+        messages.push_back(message);
+        batch.text += message;
+        batch.offsets.push_back(batch.text.size());
+    }
+    modAlphaCipher cipher(L"ЁЖИКЯЮЩ");
+    MessageBatch encrypted = cipher.encryptBatch(batch);
+    CHECK(encrypted.offsets == batch.offsets);
+    for (size_t m = 0; m < messages.size(); m++) {
+        if (!messages[m].empty()) {
+            CHECK(encrypted.text.substr(batch.offsets[m], messages[m].size()) == cipher.encrypt(messages[m]));
+        }
+    }
+    CHECK(cipher.decryptBatch(encrypted).text == batch.text);
+    CHECK(cipher.encryptBatch(batch, false).text == cipher.encrypt(batch.text));
+}
+
+TEST(TestEncryptBatchInvalid) {
+    modAlphaCipher cipher(L"БКД");
+    CHECK_THROW(cipher.encryptBatch(MessageBatch{L"БГЕЖ", {0, 2, 5}}), std::invalid_argument);
+    CHECK_THROW(cipher.encryptBatch(MessageBatch{L"БГЕЖ", {0, 3, 2, 4}}), std::invalid_argument);
+    CHECK_THROW(cipher.encryptBatch(MessageBatch{L"БГеЖ", {0, 2, 4}}), std::invalid_argument);
+}
+
+TEST(TestLatinAlphabet) {
+    latinGronsfeld cipher(L"BKD");
+    CHECK(cipher.encrypt(L"HELLOZ") == L"IOOMYC");
+    CHECK(cipher.decrypt(L"IOOMYC") == L"HELLOZ");
+    CHECK_EQUAL(cipher.encrypt(std::string_view("HELLOZ")), std::string("IOOMYC"));
+    std::string out = "HEL LO\nZ";
+    cipher.encrypt(out.data(), out.size(), &out[0]);
+    CHECK_EQUAL(out, std::string("IOO MY\nC"));
+    CHECK_THROW(cipher.encrypt(L"ПРИВЕТ"), std::invalid_argument);
+    CHECK_THROW(latinGronsfeld(L"БКД"), std::invalid_argument);
+}
+
+TEST(TestCombinedAlphabet) {
+    combinedGronsfeld cipher(L"ВA");
+    CHECK(cipher.encrypt(L"ЯZЮY") == L"BЯAЮ");
+    CHECK(cipher.decrypt(L"BЯAЮ") == L"ЯZЮY");
+    std::string out(4, '\0');
+    CHECK_THROW(cipher.encrypt("AB", 2, &out[0]), std::invalid_argument);
+}
+
+TEST(TestRuntimeAlphabet) {
+    // Русский алфавит, заданный объектом, даёт тот же шифр, что и алфавит времени компиляции.
+    const modAlphaCipher fixed(L"ШИФР");
+    const runtimeGronsfeld loaded(L"ШИФР", Alphabet::russian());
+    const std::wstring text = L"ЁЖИКВТУМАНЕЯ";
+    CHECK(loaded.encrypt(text) == fixed.encrypt(text));
+    CHECK(runtimeGronsfeld(L"ШИФР").encrypt(text) == fixed.encrypt(text));
+    const std::string utf8 = "ЁЖИКВТУМАНЕ";
+    CHECK_EQUAL(loaded.encrypt(std::string_view(utf8)), fixed.encrypt(std::string_view(utf8)));
+    std::string parallel(200000, '\0');
+    for (size_t i = 0; i < parallel.size(); i += 2) {
+        std::memcpy(&parallel[i], i % 10 == 8 ? " \n" : "Ж", 2);
+    }
+    std::string expected(parallel.size(), '\0');
+    std::string actual(parallel.size(), '\0');
+    fixed.encryptParallel(parallel.data(), parallel.size(), &expected[0], 1);
+    loaded.encryptParallel(parallel.data(), parallel.size(), &actual[0], 4);
+    CHECK(actual == expected);
+
+    // Одинаковый ключ над разными алфавитами — разные расписания.
+    CHECK(runtimeGronsfeld(L"Б", Alphabet(L"БА")).encrypt(L"АБ") == L"АБ");
+    CHECK(runtimeGronsfeld(L"Б", Alphabet::russian()).encrypt(L"АБ") == L"БВ");
+    CHECK_THROW(runtimeGronsfeld(L"Б", Alphabet::latin()), std::invalid_argument);
+
+    // Буквы одной длины в UTF-8 (2, 3 и 4 байта): побайтовый поток совпадает с целым текстом.
+    for (const std::wstring letters : {L"ΑΒΓΔΕΖΗΘ", L"あいうえおかきく", L"\U0001F600\U0001F601\U0001F602"}) {
+        const runtimeGronsfeld cipher(letters.substr(1, 2) + letters.substr(0, 1), Alphabet(letters));
+        std::wstring wide;
+        for (size_t i = 0; i < 50; i++) {
+            wide += letters[(i * 7) % letters.size()];
+        }
+        CHECK(cipher.decrypt(cipher.encrypt(wide)) == wide);
+        std::string bytes;
+        for (wchar_t c : wide) {
+            char letter[4];
+            bytes.append(letter, encodeUtf8Char(c, letter));
+        }
+        const std::string encrypted = cipher.encrypt(std::string_view(bytes));
+        CHECK_EQUAL(cipher.decrypt(std::string_view(encrypted)), bytes);
+        CipherStream<runtimeGronsfeld> stream(cipher, true);
+        std::string streamed;
+        for (char c : bytes) {
+            streamed += stream.update(std::string_view(&c, 1));
+        }
+        CHECK_EQUAL(stream.finalize(), 0u);
+        CHECK_EQUAL(streamed, encrypted);
+    }
+
+    // Буквы разной длины в UTF-8: работает только интерфейс std::wstring.
+    const runtimeGronsfeld mixed(L"Ж", Alphabet(L"AЖ"));
+    CHECK(mixed.encrypt(L"AЖ") == L"ЖA");
+    CHECK_THROW(mixed.encrypt(std::string_view("A")), std::invalid_argument);
+}
+
+TEST(TestKeyCacheManyKeys) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::vector<std::thread> workers;
+    std::vector<int> failures(4, 0);
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&, t] {
+            std::mt19937 gen(t);
+            for (int i = 0; i < 2000; i++) {
+                std::wstring key(1 + gen() % 3, L' ');
+                for (auto& c : key) {
+                    c = alphabet[gen() % 8];
+                }
+                modAlphaCipher cipher(key);
+                const std::wstring text = L"АБВГ";
+                std::wstring expected(text.size(), L' ');
+                for (size_t j = 0; j < text.size(); j++) {
+                    expected[j] = alphabet[(alphabet.find(text[j]) + alphabet.find(key[j % key.size()])) % 33];
+                }
+                failures[t] += cipher.encrypt(text) != expected;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    CHECK(failures == std::vector<int>(4, 0));
+    CHECK_THROW(modAlphaCipher(L"БкД"), std::invalid_argument);
+    CHECK_THROW(modAlphaCipher(L"БкД"), std::invalid_argument);
+}
+
+TEST(TestMetricsSnapshot) {
+    const MetricsSnapshot before = collectMetrics();
+    const modAlphaCipher cipher(L"БКД");
+    cipher.encrypt(std::wstring(L"БГЕЖ"));
+    CHECK_THROW(cipher.encrypt(std::wstring(L"бг")), std::invalid_argument);
+    std::thread([&] { cipher.encrypt(std::wstring(L"БГЕЖ")); }).join();
+    auto countBlocks = [] {
+        std::lock_guard<std::mutex> lock(metricsRegistry.mutex);
+        size_t count = 0;
+        for (ThreadMetrics* block = metricsRegistry.blocks; block != nullptr; block = block->next) {
+            count++;
+        }
+        return count;
+    };
+    // Завершившиеся потоки отдают блоки следующим, а их счётчики остаются в итоге.
+    const size_t blocks = countBlocks();
+    for (int i = 0; i < 100; i++) {
+        std::thread([&] { cipher.encrypt(std::wstring(L"Б")); }).join();
+    }
+    CHECK_EQUAL(countBlocks(), blocks);
+    const MetricsSnapshot after = collectMetrics();
+    if (after.enabled) {
+        CHECK_EQUAL(after[MetricCounter::calls] - before[MetricCounter::calls], 103u);
+        CHECK_EQUAL(after[MetricCounter::bytes] - before[MetricCounter::bytes], 110 * sizeof(wchar_t));
+        CHECK_EQUAL(after[MetricCounter::rejections] - before[MetricCounter::rejections], 1u);
+        CHECK_EQUAL(after[MetricCounter::allocations] - before[MetricCounter::allocations], 103u);
+    } else {
+        CHECK_EQUAL(after[MetricCounter::calls], 0u);
+    }
+    CHECK(formatMetrics(after, MetricsFormat::prometheus).find("cipher_calls_total ") != std::string::npos);
+    CHECK(formatMetrics(after, MetricsFormat::json).find("\"phases\": {\"validate\"") != std::string::npos);
+}
+
+TEST(TestCrackRecoversKey) {
+    // Буквы выбираются с частотами русского текста, через 6 букв — пробел.
+    std::mt19937 gen(21);
+    std::string text;
+    for (wchar_t c : russianText(20000, 6, gen)) {
+        char letter[4];
+        text.append(letter, encodeUtf8Char(c, letter));
+    }
+    const modAlphaCipher cipher(L"ШИФРОВАНИЕ");
+    std::string encrypted(text.size(), '\0');
+    cipher.encrypt(text.data(), text.size(), &encrypted[0]);
+
+    const CrackResult result = crackGronsfeld(encrypted);
+    CHECK(result.key == L"ШИФРОВАНИЕ");
+    CHECK_EQUAL(result.letters, 20000u);
+    CHECK_EQUAL(guessKeyLength(result.lengths), 10u);
+    CHECK(result.lengths[19].coincidence > 0.045);
+    CHECK(result.lengths[10].coincidence < 0.04);
+    CHECK_THROW(crackGronsfeld(std::string_view("А, б!")), std::invalid_argument);
+}
+
+TEST(TestSharedInstanceConcurrentUse) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::mt19937 gen(6);
+    std::wstring text(3000, L' ');
+    for (auto& c : text) {
+        c = alphabet[gen() % alphabet.size()];
+    }
+    const modAlphaCipher cipher(L"ЁЖИКЯЮЩ");
+    const std::wstring expected = cipher.encrypt(text);
+    const std::string utf8 = cipher.encrypt(std::string_view("БГЕЖБГЕЖ"));
+    std::vector<int> failures(8, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; t++) {
+        workers.emplace_back([&, t] {
+            std::wstring out(text.size(), L'\0');
+            for (int i = 0; i < 200; i++) {
+                failures[t] += cipher.encrypt(text) != expected;
+                cipher.encrypt(text.data(), text.size(), &out[0]);
+                cipher.decrypt(out.data(), out.size(), &out[0]);
+                failures[t] += out != text;
+                failures[t] += cipher.encrypt(std::string_view("БГЕЖБГЕЖ")) != utf8;
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    CHECK(failures == std::vector<int>(8, 0));
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,89 @@
+/**
+ * @file bench_permutationSearch.cpp
+ * @brief Замер скорости перебора ключей modPermutationCipher (ключей в секунду).
+ *
+ * @details
+ * Шифротекст — случайный текст с частотами букв русского языка, зашифрованный ключом
+ * из 6 цифр; перебираются все ключи длины 1…6 (1 111 110 ключей). Скорость
+ * сравнивается для разной длины расшифровываемого начала, с отсечением и без него,
+ * на одном потоке и на всех ядрах; отдельно — перебор ключей длины до 9 и до 12
+ * с отсечением. Скорость — число ключей, оценённых или пропущенных отсечением, в секунду.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "modPermutation.h"
+#include "permutationSearch.h"
+#include "../common/russianFrequencies.h"
+#include <algorithm>
+#include <chrono>
+#include <codecvt>
+#include <cstdio>
+#include <locale>
+#include <random>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Случайный русский текст с частотами букв (см. russianFrequencies.h), слова по 5 букв.
+ */
+std::string randomRussian(size_t letters) {
+    std::mt19937 gen(22);
+    const std::wstring text = russianText(letters, 5, gen);
+    return std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(text);
+}
+
+/**
+ * @brief Перебирает ключи несколько раз и возвращает лучшую скорость в млн ключей/с.
+ */
+double measure(const std::string& ciphertext, const BigramModel& model, const SearchOptions& options,
+               SearchResult& result, int repeats) {
+    double best = 0;
+    for (int r = 0; r < repeats; r++) {
+        const auto start = std::chrono::steady_clock::now();
+        result = searchPermutationKey(ciphertext, model, options);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::max(best, result.keysTried / seconds / 1e6);
+    }
+    return best;
+}
+
+} // namespace
+
+int main() {
+    const std::string plain = randomRussian(4096);
+    std::string ciphertext(2 * plain.size(), '\0');
+    size_t phase = 0;
+    ciphertext.resize(modPermutationCipher(L"271828").encrypt(plain.data(), plain.size(), &ciphertext[0], phase));
+    const BigramModel model = BigramModel::russian();
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::printf("%8s %8s %8s %8s %14s %12s %12s\n", "length", "prefix", "threads", "abort", "Mkeys/s", "pruned, %",
+                "best key");
+    auto run = [&](size_t length, size_t prefix, unsigned threads, bool earlyAbort) {
+        SearchOptions options;
+        options.maxKeyLength = length;
+        options.prefixLetters = prefix;
+        options.threads = threads;
+        options.earlyAbort = earlyAbort;
+        SearchResult result;
+        const double speed = measure(ciphertext, model, options, result, 3);
+        std::printf("%8zu %8zu %8u %8s %14.1f %12.4f %12s\n", length, prefix, threads, earlyAbort ? "yes" : "no",
+                    speed, 100.0 * result.keysPruned / result.keysTried,
+                    std::string(result.candidates[0].key.begin(), result.candidates[0].key.end()).c_str());
+    };
+    for (size_t prefix : {32u, 64u, 256u, 1024u}) {
+        for (unsigned threads : {1u, cores}) {
+            run(6, prefix, threads, false);
+            run(6, prefix, threads, true);
+            if (cores == 1) {
+                break;
+            }
+        }
+    }
+    run(9, 1024, cores, true);
+    run(12, 1024, cores, true);
+    return 0;
+}
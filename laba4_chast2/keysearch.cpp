@@ -0,0 +1,95 @@
+/**
+ * @file keysearch.cpp
+ * @brief Поиск ключа modPermutationCipher перебором по шифротексту.
+ *
+ * @details
+ * Формат вызова:
+ * @code
+ * keysearch [--max-length L] [--prefix P] [--top K] [--threads N] [--corpus ОБРАЗЕЦ] [ФАЙЛ]
+ * @endcode
+ * Без файла (или с `-`) шифротекст читается из stdin. `--corpus` обучает модель биграмм
+ * на образце открытого текста (по умолчанию — модель русского текста по частотам букв).
+ * Лучшие ключи печатаются в stdout по одному на строку с оценкой, число перебранных
+ * ключей и скорость перебора — в stderr.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "permutationSearch.h"
+#include "../common/mappedFile.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Точка входа: разбирает аргументы, перебирает ключи и печатает лучшие.
+ *
+ * @return int 0 при успехе, 1 при ошибке.
+ */
+int main(int argc, char** argv) {
+    SearchOptions options;
+    const char* file = "-";
+    const char* corpus = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--max-length") == 0 && i + 1 < argc) {
+            options.maxKeyLength = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--prefix") == 0 && i + 1 < argc) {
+            options.prefixLetters = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--top") == 0 && i + 1 < argc) {
+            options.top = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--corpus") == 0 && i + 1 < argc) {
+            corpus = argv[++i];
+        } else if (argv[i][0] != '-' || argv[i][1] == '\0') {
+            file = argv[i];
+        } else {
+            std::cerr << "Использование: " << argv[0]
+                      << " [--max-length L] [--prefix P] [--top K] [--threads N] [--corpus ОБРАЗЕЦ] [ФАЙЛ]\n";
+            return 1;
+        }
+    }
+
+    try {
+        const BigramModel model = corpus != nullptr ? [corpus] {
+            const MappedFile sample{std::string(corpus)};
+            return BigramModel(std::string_view(sample.data(), sample.size()));
+        }() : BigramModel::russian();
+
+        const auto start = std::chrono::steady_clock::now();
+        SearchResult result;
+        if (std::strcmp(file, "-") != 0) {
+            const MappedFile input{std::string(file)};
+            result = searchPermutationKey(std::string_view(input.data(), input.size()), model, options);
+        } else {
+            std::string text;
+            char block[1 << 16];
+            size_t read;
+            while ((read = std::fread(block, 1, sizeof(block), stdin)) > 0) {
+                text.append(block, read);
+            }
+            if (std::ferror(stdin)) {
+                throw std::runtime_error("Ошибка чтения.");
+            }
+            result = searchPermutationKey(std::string_view(text), model, options);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        for (const KeyCandidate& candidate : result.candidates) {
+            std::printf("%s %.4f\n", std::string(candidate.key.begin(), candidate.key.end()).c_str(), candidate.score);
+        }
+        std::fprintf(stderr, "ключей: %llu, отсечено: %llu, пар букв: %zu, время: %.3f с, %.1f млн ключей/с\n",
+                     static_cast<unsigned long long>(result.keysTried),
+                     static_cast<unsigned long long>(result.keysPruned), result.pairs, elapsed.count(),
+                     result.keysTried / elapsed.count() / 1e6);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
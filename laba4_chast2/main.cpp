@@ -7,15 +7,29 @@
  * Пользователь может вводить текст и ключ, а затем выбрать операцию (шифрование или расшифрование).
  * Программа также включает обработку ошибок и вывод сообщений об исключениях.
  *
+ * При запуске с аргументами работает в потоковом режиме без диалога:
+ * @code
+ * cipher -e -k 123 < in.txt > out.txt
+ * cipher -d -k 123 --threads 8 in.txt out.txt
+ * cipher -e -k 123 --timing in.txt > out.txt
+ * cipher -e -k 123 --alphabet greek.txt < in.txt > out.txt
+ * @endcode
+ *
  * @author Бренинг И. А.
  * @date 30 ноября 2024 года
  */
 
+#include <cstdio>
 #include <iostream>
 #include <locale>
 #include <codecvt>
-#include <stdexcept>
 #include "modPermutation.h"
+#include "../common/streamMode.h"
+
+/**
+ * @brief Размер блока чтения в потоковом режиме (байт на поток).
+ */
+constexpr size_t chunkSize = 1 << 20;
 
 /**
  * @brief Функция для конвертации сообщений исключений в строку типа std::wstring.
@@ -32,16 +46,70 @@ std::wstring convertExceptionMessage(const std::exception& e) {
     return converter.from_bytes(errorMessage); // Конвертируем в wstring
 }
 
+/**
+ * @brief Шифрует или расшифровывает поток блоками постоянного размера.
+ *
+ * @details
+ * Поток читается блоками по `chunkSize` байт на поток и шифруется прямо в UTF-8,
+ * поэтому расход памяти не зависит от размера входа. Чтение, шифрование и запись
+ * идут одновременно на кольце буферов (см. runPipeline()). Пробельные символы
+ * копируются без изменений и не сдвигают ключ; позиция ключа переносится через границы блоков.
+ *
+ * @param cipher Шифр с установленным ключом.
+ * @param encrypt true для шифрования, false для расшифрования.
+ * @param threads Число потоков шифрования.
+ * @param in Входной поток.
+ * @param out Выходной поток.
+ * @return PipelineTiming Время чтения, шифрования и записи.
+ * @throws std::invalid_argument Если вход содержит недопустимые символы.
+ * @throws std::runtime_error При ошибке чтения или записи.
+ */
+PipelineTiming processStream(const modPermutationCipher& cipher, bool encrypt, unsigned threads, std::FILE* in,
+                             std::FILE* out) {
+    size_t phase = 0;
+    auto transform = [&](const char* block, size_t length, char* result) {
+        return encrypt ? cipher.encryptParallel(block, length, result, threads, phase)
+                       : cipher.decryptParallel(block, length, result, threads, phase);
+    };
+    // Буква может смениться более длинной, поэтому результат блока длиннее входа
+    // не больше чем в наибольшую длину буквы алфавита (см. utf8Capacity()).
+    return runPipeline(in, out, chunkSize * threads, cipher.getAlphabet().maxUtf8Length(), transform,
+                       "Ошибка чтения.", "Ошибка записи.");
+}
+
+/**
+ * @brief Потоковый режим: разбирает аргументы и обрабатывает файл или канал.
+ *
+ * @details
+ * Аргументы, файлы и вывод времени и счётчиков — общие с другими программами (см. common/streamMode.h).
+ * `--alphabet ФАЙЛ` загружает алфавит шифра из файла, по умолчанию — прописные русские и латинские буквы.
+ * Если указаны оба файла, они отображаются в память (см. modPermutationCipher::encryptFile()).
+ *
+ * @return int 0 при успехе, 1 при ошибке.
+ */
+int runStream(int argc, char** argv) {
+    return runStreamMode(argc, argv, [](const StreamOptions& options, StreamSession& session) {
+        const Alphabet alphabet =
+            options.alphabetFile != nullptr ? Alphabet::fromFile(options.alphabetFile) : Alphabet::russianLatin();
+        session.run(modPermutationCipher(decodeKey(options.key), alphabet), processStream);
+    });
+}
+
 /**
  * @brief Основная функция программы.
  *
  * В основной функции происходит взаимодействие с пользователем для выбора операции шифрования или расшифрования.
  * Пользователь вводит ключ и текст, а программа выполняет шифрование или расшифрование, в зависимости от выбора.
  * Также реализована обработка ошибок с выводом сообщений об исключениях.
+ * При наличии аргументов командной строки запускается потоковый режим (см. runStream()).
  * 
  * @return int Возвращает 0 при успешном завершении программы.
  */
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return runStream(argc, argv);
+    }
+
     setlocale(LC_ALL, "ru_RU.UTF-8"); // Устанавливаем локаль для работы с русским языком
 
     try {
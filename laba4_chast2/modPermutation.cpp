@@ -7,32 +7,81 @@
  * модификацию, при которой каждый символ сдвигается на значение, заданное векторами ключа.
  * Включена валидация входных данных, таких как ключ и текст.
  *
- * @note Поддерживаются только русские и английские буквы.
+ * @note Алфавит задаётся объектом Alphabet; по умолчанию — русские и английские буквы.
  * @author Бренинг И. А.
  */
 
 #include "modPermutation.h"
+#include "../common/mappedFile.h"
+#include "../common/metrics.h"
+#include "../common/parallel.h"
+#include "../common/utf8.h"
+#include <cstring>
 #include <stdexcept>
 #include <locale>
 
+namespace {
+
+/**
+ * @brief Пробельные символы, которые в UTF-8-режиме копируются без шифрования.
+ */
+bool isSpace(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * @brief Считает символы текста UTF-8, которые сдвигают ключ (всё, кроме пробелов).
+ */
+size_t countLetters(const char* text, size_t length) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; ++i) {
+        const unsigned char c = static_cast<unsigned char>(text[i]);
+        count += (c & 0xC0) != 0x80 && !isSpace(c);
+    }
+    return count;
+}
+
+} // namespace
+
 /**
  * @brief Конструктор класса modPermutationCipher.
  *
- * Конструктор инициализирует объект с переданным ключом. Также выполняется проверка
+ * Конструктор инициализирует объект с переданным ключом и алфавитом. Также выполняется проверка
  * ключа на корректность: он должен быть непустым и содержать только цифры.
+ * Таблицы номеров букв берутся у алфавита, здесь строятся только таблицы сдвига.
  * 
  * @param skey Ключ в виде строки, состоящей из цифр.
+ * @param alphabet Алфавит шифра.
  * @throws std::invalid_argument Исключение выбрасывается, если ключ пуст или содержит недопустимые символы.
  */
-modPermutationCipher::modPermutationCipher(const std::wstring& skey) {
+modPermutationCipher::modPermutationCipher(const std::wstring& skey, const Alphabet& alphabet) : alphabet(alphabet) {
     if (skey.empty()) {
         throw std::invalid_argument("Ошибка: ключ не может быть пустым. Пожалуйста, введите положительное целое число.");
     }
-    alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯABCDEFGHIJKLMNOPQRSTUVWXYZ"; // поддержка русского и английского алфавитов
     validateKey(skey);
     for (auto& ch : skey) {
         key.push_back(wchar_t(ch) - L'0');
     }
+
+    utf8Alpha.assign(4 * alphabet.size(), '\0');
+    for (size_t i = 0; i < alphabet.size(); ++i) {
+        const size_t width = encodeUtf8Char(static_cast<std::uint32_t>(alphabet.letter(i)), &utf8Alpha[4 * i]);
+        utf8Length.push_back(static_cast<unsigned char>(width));
+    }
+
+    const size_t size = alphabet.size();
+    encryptTable.fill(0);
+    decryptTable.fill(0);
+    alphaTable.fill(L'\0');
+    for (size_t shift = 0; shift < shiftCount; ++shift) {
+        for (size_t i = 0; i < size; ++i) {
+            encryptTable[shift * rowSize + i] = static_cast<unsigned char>((i + shift) % size);
+            decryptTable[shift * rowSize + i] = static_cast<unsigned char>((i + size - shift % size) % size);
+        }
+    }
+    for (size_t i = 0; i < size; ++i) {
+        alphaTable[i] = alphabet.letter(i);
+    }
 }
 
 /**
@@ -43,15 +92,16 @@ modPermutationCipher::modPermutationCipher(const std::wstring& skey) {
  * @param skey Ключ в виде строки.
  * @throws std::invalid_argument Исключение выбрасывается, если ключ содержит нецифровые символы или является неположительным.
  */
-void modPermutationCipher::validateKey(const std::wstring& skey) {
+void modPermutationCipher::validateKey(const std::wstring& skey) const {
     for (const auto& ch : skey) {
         if (!iswdigit(ch)) {
             throw std::invalid_argument("Ошибка: ключ должен состоять только из цифр. Пожалуйста, введите положительное целое число.");
         }
     }
 
-    int keyValue = std::stoi(skey);
-    if (keyValue <= 0) {
+    // Ключ может быть длиннее, чем помещается в int, поэтому положительность
+    // проверяется по наличию ненулевой цифры.
+    if (skey.find_first_not_of(L'0') == std::wstring::npos) {
         throw std::invalid_argument("Ошибка: ключ должен быть положительным целым числом. Пожалуйста, введите корректный ключ.");
     }
 }
@@ -59,20 +109,93 @@ void modPermutationCipher::validateKey(const std::wstring& skey) {
 /**
  * @brief Функция для валидации текста.
  *
- * Проверяет, что текст не пуст и состоит только из символов заданного алфавита (русские и английские буквы).
+ * Проверяет, что текст не пуст и состоит только из символов алфавита шифра.
  * 
  * @param text Текст для шифрования или расшифрования.
  * @throws std::invalid_argument Исключение выбрасывается, если текст содержит недопустимые символы.
  */
-void modPermutationCipher::validateText(const std::wstring& text) {
+void modPermutationCipher::validateText(const std::wstring& text) const {
     if (text.empty()) {
         throw std::invalid_argument("Ошибка: текст не может быть пустым.");
     }
-    for (const auto& ch : text) {
-        if (alphabet.find(ch) == std::wstring::npos) {
-            throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+    if (findInvalid(text.data(), text.size()) != text.size()) {
+        throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+    }
+}
+
+/**
+ * @brief Находит первый символ, не входящий в алфавит.
+ *
+ * Алфавит по умолчанию — прописные русские и латинские буквы, для него проверка
+ * сводится к сравнению кодов с границами трёх отрезков.
+ *
+ * @param text Текст.
+ * @param length Количество символов.
+ * @return size_t Позиция первого недопустимого символа или `length`.
+ */
+size_t modPermutationCipher::findInvalid(const wchar_t* text, size_t length) const noexcept {
+    return alphabet.findInvalid(text, length);
+}
+
+/**
+ * @brief Проверяет и сдвигает текст без исключений.
+ *
+ * Блок сначала проверяется сравнением с границами алфавита, затем номер каждого
+ * символа берётся из таблицы индексов, а сдвинутый номер — из таблицы подстановки
+ * для текущей цифры ключа, поэтому сдвиг выполняется за O(n) без поиска по алфавиту и без деления.
+ *
+ * @param text Входной текст.
+ * @param length Количество символов.
+ * @param out Буфер результата.
+ * @param forward true для шифрования, false для расшифрования.
+ * @param phase Позиция ключа для первого символа.
+ * @return CipherResult Код результата, позиция ошибки и позиция ключа после текста.
+ */
+CipherResult modPermutationCipher::shift(const wchar_t* text, size_t length, wchar_t* out, bool forward,
+                                         size_t phase) const noexcept {
+    const unsigned char* table = forward ? encryptTable.data() : decryptTable.data();
+    const int* shift = key.data();
+    const size_t keySize = key.size();
+    size_t k = phase % keySize;
+    METRIC_COUNT(calls, 1);
+    METRIC_COUNT(bytes, length * sizeof(wchar_t));
+    return alphabet.withLookup([&](auto index) {
+        for (size_t pos = 0; pos < length; pos += blockSize) {
+            const size_t n = std::min(blockSize, length - pos);
+            const size_t invalid = METRIC_TIME(validate, findInvalid(text + pos, n));
+            if (invalid != n) {
+                METRIC_COUNT(rejections, 1);
+                return CipherResult{CipherStatus::invalidCharacter, pos + invalid, k};
+            }
+            // Номер символа, сдвиг и символ по номеру — три обращения к таблицам в одном цикле.
+            METRIC_PHASE(shift);
+            for (size_t i = pos; i < pos + n; ++i) {
+                out[i] = alphaTable[table[shift[k] * rowSize + index(text[i])]];
+                k = k + 1 == keySize ? 0 : k + 1;
+            }
         }
+        return CipherResult{CipherStatus::ok, length, k};
+    });
+}
+
+/**
+ * @brief Проверяет и сдвигает текст, сообщая об ошибке исключением.
+ *
+ * @param text Входной текст.
+ * @param forward true для шифрования, false для расшифрования.
+ * @return std::wstring Результат.
+ * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
+ */
+std::wstring modPermutationCipher::shift(const std::wstring& text, bool forward) const {
+    if (text.empty()) {
+        throw std::invalid_argument("Ошибка: текст не может быть пустым.");
+    }
+    std::wstring result = METRIC_TIME(allocate, std::wstring(text.size(), L'\0'));
+    METRIC_COUNT(allocations, 1);
+    if (!shift(text.data(), text.size(), &result[0], forward, 0)) {
+        throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
     }
+    return result;
 }
 
 /**
@@ -83,20 +206,8 @@ void modPermutationCipher::validateText(const std::wstring& text) {
  * @param open_text Текст для шифрования.
  * @return std::wstring Зашифрованный текст.
  */
-std::wstring modPermutationCipher::encrypt(const std::wstring& open_text) {
-    validateText(open_text);
-    std::wstring result;
-    int keySize = key.size();
-
-    for (size_t i = 0; i < open_text.size(); ++i) {
-        int shift = key[i % keySize];
-        wchar_t ch = open_text[i];
-        size_t index = alphabet.find(ch);
-        if (index != std::wstring::npos) {
-            result.push_back(alphabet[(index + shift) % alphabet.size()]);
-        }
-    }
-    return result;
+std::wstring modPermutationCipher::encrypt(const std::wstring& open_text) const {
+    return shift(open_text, true);
 }
 
 /**
@@ -107,18 +218,365 @@ std::wstring modPermutationCipher::encrypt(const std::wstring& open_text) {
  * @param cipher_text Текст для расшифрования.
  * @return std::wstring Расшифрованный текст.
  */
-std::wstring modPermutationCipher::decrypt(const std::wstring& cipher_text) {
-    validateText(cipher_text);
-    std::wstring result;
-    int keySize = key.size();
-
-    for (size_t i = 0; i < cipher_text.size(); ++i) {
-        int shift = key[i % keySize];
-        wchar_t ch = cipher_text[i];
-        size_t index = alphabet.find(ch);
-        if (index != std::wstring::npos) {
-            result.push_back(alphabet[(index - shift + alphabet.size()) % alphabet.size()]);
+std::wstring modPermutationCipher::decrypt(const std::wstring& cipher_text) const {
+    return shift(cipher_text, false);
+}
+
+/**
+ * @brief Шифрует текст в буфер без исключений.
+ *
+ * @param open_text Текст для шифрования.
+ * @param length Количество символов.
+ * @param out Буфер результата.
+ * @param phase Позиция ключа для первого символа.
+ * @return CipherResult Код результата, позиция ошибки и позиция ключа после текста.
+ */
+CipherResult modPermutationCipher::tryEncrypt(const wchar_t* open_text, size_t length, wchar_t* out,
+                                              size_t phase) const noexcept {
+    return shift(open_text, length, out, true, phase);
+}
+
+/**
+ * @brief Расшифровывает текст в буфер без исключений.
+ *
+ * @param cipher_text Текст для расшифрования.
+ * @param length Количество символов.
+ * @param out Буфер результата.
+ * @param phase Позиция ключа для первого символа.
+ * @return CipherResult Код результата, позиция ошибки и позиция ключа после текста.
+ */
+CipherResult modPermutationCipher::tryDecrypt(const wchar_t* cipher_text, size_t length, wchar_t* out,
+                                              size_t phase) const noexcept {
+    return shift(cipher_text, length, out, false, phase);
+}
+
+/**
+ * @brief Сдвигает символы, стоящие в тексте с шагом `stride`.
+ *
+ * Позиция ключа шагает на `stride mod N` с одним вычитанием вместо деления.
+ */
+template <bool gather>
+void modPermutationCipher::shiftStrided(const wchar_t* text, wchar_t* out, size_t start, size_t stride,
+                                        size_t count) const {
+    const unsigned char* table = gather ? encryptTable.data() : decryptTable.data();
+    const size_t keySize = key.size();
+    const size_t step = stride % keySize;
+    size_t k = start % keySize;
+    METRIC_COUNT(calls, 1);
+    METRIC_COUNT(bytes, count * sizeof(wchar_t));
+    for (size_t i = 0, pos = start; i < count; i++, pos += stride) {
+        const int index = indexOf(gather ? text[pos] : text[i]);
+        if (index == Alphabet::invalidIndex) {
+            METRIC_COUNT(rejections, 1);
+            throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+        }
+        (gather ? out[i] : out[pos]) = alphaTable[table[key[k] * rowSize + index]];
+        k += step;
+        k -= k >= keySize ? keySize : 0;
+    }
+}
+
+/**
+ * @brief Шифрует символы текста, взятые с шагом `stride`, в непрерывный буфер.
+ *
+ * @param open_text Открытый текст.
+ * @param start Позиция первого символа.
+ * @param stride Шаг между символами.
+ * @param count Количество символов.
+ * @param out Буфер результата.
+ * @throws std::invalid_argument Если среди символов есть недопустимые.
+ */
+void modPermutationCipher::encryptStrided(const wchar_t* open_text, size_t start, size_t stride, size_t count,
+                                          wchar_t* out) const {
+    shiftStrided<true>(open_text, out, start, stride, count);
+}
+
+/**
+ * @brief Расшифровывает непрерывный буфер в позиции текста с шагом `stride`.
+ *
+ * @param cipher_text Шифротекст.
+ * @param count Количество символов.
+ * @param out Открытый текст.
+ * @param start Позиция первого символа в `out`.
+ * @param stride Шаг между символами в `out`.
+ * @throws std::invalid_argument Если среди символов есть недопустимые.
+ */
+void modPermutationCipher::decryptStrided(const wchar_t* cipher_text, size_t count, wchar_t* out, size_t start,
+                                          size_t stride) const {
+    shiftStrided<false>(cipher_text, out, start, stride, count);
+}
+
+/**
+ * @brief Сдвигает текст в UTF-8 за один проход без перевода в wchar_t.
+ *
+ * Каждый символ декодируется из одного–четырёх байт (одно- и двухбайтовые — без вызова
+ * общего декодера), ищется в таблице индексов, сдвигается на значение ключа и сразу
+ * записывается в UTF-8.
+ */
+size_t modPermutationCipher::shiftUtf8(const char* text, size_t length, char* out, bool forward, size_t& phase,
+                                       bool keepSpaces) const {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(text);
+    const unsigned char* table = forward ? encryptTable.data() : decryptTable.data();
+    size_t k = phase % key.size();
+    size_t written = 0;
+    METRIC_COUNT(calls, 1);
+    METRIC_COUNT(bytes, length);
+    // Разбор UTF-8, проверка, сдвиг и запись слиты в один проход и считаются преобразованием.
+    METRIC_PHASE(convert);
+    for (size_t i = 0; i < length;) {
+        const unsigned char lead = in[i];
+        std::uint32_t code = lead;
+        if (lead < 0x80) {
+            if (isSpace(lead) && keepSpaces) {
+                out[written++] = static_cast<char>(lead);
+                ++i;
+                continue;
+            }
+            ++i;
+        } else if (lead >= 0xC2 && lead < 0xE0 && i + 1 < length && (in[i + 1] & 0xC0) == 0x80) {
+            code = ((lead & 0x1F) << 6) | (in[i + 1] & 0x3F);
+            i += 2;
+        } else {
+            const size_t width = decodeUtf8Char(text + i, length - i, code);
+            if (width == 0) {
+                METRIC_COUNT(rejections, 1);
+                throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+            }
+            i += width;
+        }
+        const int letter = indexOf(static_cast<wchar_t>(code));
+        if (letter == Alphabet::invalidIndex) {
+            METRIC_COUNT(rejections, 1);
+            throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+        }
+        const int index = table[key[k] * rowSize + letter];
+        const char* bytes = &utf8Alpha[4 * index];
+        const size_t width = utf8Length[index];
+        out[written] = bytes[0];
+        if (width > 1) {
+            out[written + 1] = bytes[1];
+            for (size_t b = 2; b < width; ++b) {
+                out[written + b] = bytes[b];
+            }
+        }
+        written += width;
+        if (++k == key.size()) {
+            k = 0;
+        }
+    }
+    phase = k;
+    return written;
+}
+
+/**
+ * @brief Функция для шифрования текста в UTF-8.
+ *
+ * @param open_text Текст для шифрования.
+ * @return std::string Зашифрованный текст.
+ */
+std::string modPermutationCipher::encrypt(std::string_view open_text) const {
+    if (open_text.empty()) {
+        throw std::invalid_argument("Ошибка: текст не может быть пустым.");
+    }
+    std::string result = METRIC_TIME(allocate, std::string(utf8Capacity(open_text.size()), '\0'));
+    METRIC_COUNT(allocations, 1);
+    size_t phase = 0;
+    result.resize(shiftUtf8(open_text.data(), open_text.size(), &result[0], true, phase, false));
+    return result;
+}
+
+/**
+ * @brief Функция для расшифрования текста в UTF-8.
+ *
+ * @param cipher_text Текст для расшифрования.
+ * @return std::string Расшифрованный текст.
+ */
+std::string modPermutationCipher::decrypt(std::string_view cipher_text) const {
+    if (cipher_text.empty()) {
+        throw std::invalid_argument("Ошибка: текст не может быть пустым.");
+    }
+    std::string result = METRIC_TIME(allocate, std::string(utf8Capacity(cipher_text.size()), '\0'));
+    METRIC_COUNT(allocations, 1);
+    size_t phase = 0;
+    result.resize(shiftUtf8(cipher_text.data(), cipher_text.size(), &result[0], false, phase, false));
+    return result;
+}
+
+/**
+ * @brief Функция для шифрования байтов UTF-8 в буфер вызывающей стороны.
+ */
+size_t modPermutationCipher::encrypt(const char* open_text, size_t length, char* out, size_t& phase) const {
+    return shiftUtf8(open_text, length, out, true, phase);
+}
+
+/**
+ * @brief Функция для расшифрования байтов UTF-8 в буфер вызывающей стороны.
+ */
+size_t modPermutationCipher::decrypt(const char* cipher_text, size_t length, char* out, size_t& phase) const {
+    return shiftUtf8(cipher_text, length, out, false, phase);
+}
+
+/**
+ * @brief Многопоточная обработка: позиция ключа и смещение результата передаются от блока к блоку.
+ */
+size_t modPermutationCipher::shiftUtf8Parallel(const char* text, size_t length, char* out, bool forward,
+                                               size_t& phase, unsigned threads) const {
+    threads = parallelThreads(threads, length);
+    if (threads == 1) {
+        return shiftUtf8(text, length, out, forward, phase);
+    }
+    // Длина результата блока известна только после шифрования, поэтому блок шифруется
+    // в буфер потока и копируется в выход, когда предыдущий блок опубликует своё смещение.
+    const size_t blocks = (length + parallelBlock - 1) / parallelBlock;
+    BlockChain phases(blocks, phase % key.size());
+    BlockChain offsets(blocks, 0);
+    runBlocks(threads, blocks, [&](size_t block) {
+        thread_local std::vector<char> scratch;
+        const size_t begin = utf8Boundary(text, length, block * parallelBlock);
+        const size_t end = utf8Boundary(text, length, (block + 1) * parallelBlock);
+        const size_t letters = countLetters(text + begin, end - begin);
+        size_t blockPhase = phases.wait(block);
+        phases.publish(block, (blockPhase + letters) % key.size());
+        scratch.resize(utf8Capacity(end - begin));
+        const size_t written = shiftUtf8(text + begin, end - begin, scratch.data(), forward, blockPhase);
+        const size_t offset = offsets.wait(block);
+        offsets.publish(block, offset + written);
+        std::memcpy(out + offset, scratch.data(), written);
+    }, phases, offsets);
+    phase = phases.wait(blocks);
+    return offsets.wait(blocks);
+}
+
+/**
+ * @brief Функция для многопоточного шифрования байтов UTF-8.
+ */
+size_t modPermutationCipher::encryptParallel(const char* open_text, size_t length, char* out, unsigned threads,
+                                             size_t& phase) const {
+    return shiftUtf8Parallel(open_text, length, out, true, phase, threads);
+}
+
+/**
+ * @brief Функция для многопоточного расшифрования байтов UTF-8.
+ */
+size_t modPermutationCipher::decryptParallel(const char* cipher_text, size_t length, char* out, unsigned threads,
+                                             size_t& phase) const {
+    return shiftUtf8Parallel(cipher_text, length, out, false, phase, threads);
+}
+
+/**
+ * @brief Обрабатывает отображённый в память файл; выход создаётся с запасом и обрезается.
+ */
+void modPermutationCipher::shiftFile(const std::string& input, const std::string& output, bool forward,
+                                     unsigned threads) const {
+    MappedFile in(input);
+    MappedFile out(output, utf8Capacity(in.size()));
+    size_t phase = 0;
+    const size_t written = shiftUtf8Parallel(in.data(), in.size(), out.data(), forward, phase, threads);
+    out.truncate(written);
+    out.commit();
+}
+
+/**
+ * @brief Функция для шифрования файла через отображение в память.
+ */
+void modPermutationCipher::encryptFile(const std::string& input, const std::string& output, unsigned threads) const {
+    shiftFile(input, output, true, threads);
+}
+
+/**
+ * @brief Функция для расшифрования файла через отображение в память.
+ */
+void modPermutationCipher::decryptFile(const std::string& input, const std::string& output, unsigned threads) const {
+    shiftFile(input, output, false, threads);
+}
+
+/**
+ * @brief Создаёт потоковый контекст для одного направления.
+ */
+CipherStream<modPermutationCipher>::CipherStream(const modPermutationCipher& cipher, bool forward)
+    : cipher(cipher), forward(forward) {}
+
+/**
+ * @brief Сдвигает фрагмент, продолжая ключ с позиции предыдущего.
+ */
+size_t CipherStream<modPermutationCipher>::update(const wchar_t* in, size_t length, wchar_t* out) {
+    const CipherResult result = forward ? cipher.tryEncrypt(in, length, out, phase)
+                                        : cipher.tryDecrypt(in, length, out, phase);
+    if (!result) {
+        throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+    }
+    phase = result.phase;
+    return length;
+}
+
+std::wstring CipherStream<modPermutationCipher>::update(const std::wstring& fragment) {
+    std::wstring result(fragment.size(), L'\0');
+    update(fragment.data(), fragment.size(), &result[0]);
+    return result;
+}
+
+size_t CipherStream<modPermutationCipher>::shiftUtf8(const char* in, size_t length, char* out, size_t& next) const {
+    return forward ? cipher.encrypt(in, length, out, next) : cipher.decrypt(in, length, out, next);
+}
+
+/**
+ * @brief Сдвигает фрагмент UTF-8, склеивая букву, разорванную границей фрагментов.
+ *
+ * Начало оборванной буквы дополняется байтами продолжения из начала следующего
+ * фрагмента и сдвигается отдельно, остальное — одним вызовом шифра. Если фрагмент
+ * слишком короток, чтобы закончить букву, его байты добавляются к её началу.
+ * Позиция ключа и оборванная буква меняются только после успешной обработки всего фрагмента.
+ */
+size_t CipherStream<modPermutationCipher>::update(const char* in, size_t length, char* out) {
+    size_t next = phase;
+    size_t written = 0;
+    char letter[4];
+    size_t have = carried;
+    std::memcpy(letter, carry, carried);
+    if (have > 0) {
+        const size_t size = utf8CharLength(static_cast<unsigned char>(letter[0]));
+        const size_t taken = std::min(size - have, length);
+        for (size_t i = 0; i < taken; ++i) {
+            if ((static_cast<unsigned char>(in[i]) & 0xC0) != 0x80) {
+                throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+            }
+            letter[have++] = in[i];
+        }
+        in += taken;
+        length -= taken;
+        if (have == size) {
+            written = shiftUtf8(letter, size, out, next);
+            have = 0;
         }
     }
+    // Многобайтовая буква может разорваться границей фрагмента: её начало ждёт следующего.
+    const size_t tail = utf8Tail(in, length);
+    written += shiftUtf8(in, length - tail, out + written, next);
+    if (tail > 0) {
+        std::memcpy(letter, in + length - tail, tail);
+        have = tail;
+    }
+    std::memcpy(carry, letter, have);
+    carried = have;
+    phase = next;
+    return written;
+}
+
+std::string CipherStream<modPermutationCipher>::update(std::string_view fragment) {
+    std::string result(cipher.utf8Capacity(fragment.size()), '\0');
+    result.resize(update(fragment.data(), fragment.size(), &result[0]));
     return result;
 }
+
+/**
+ * @brief Завершает сообщение: проверяет, что поток UTF-8 не оборвался посреди буквы.
+ */
+size_t CipherStream<modPermutationCipher>::finalize(wchar_t*) {
+    const bool truncated = carried > 0;
+    phase = 0;
+    carried = 0;
+    if (truncated) {
+        throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+    }
+    return 0;
+}
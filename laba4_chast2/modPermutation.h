@@ -5,10 +5,14 @@
  * Этот файл содержит объявление класса modPermutationCipher, который предоставляет методы
  * для шифрования и расшифрования текста с использованием перестановки с ключом.
  *
- * @details Реализует базовую функциональность шифра с поддержкой русского и английского алфавитов.
+ * @details Реализует базовую функциональность шифра над алфавитом, заданным объектом Alphabet
+ * (common/runtimeAlphabet.h); по умолчанию — прописные русские и английские буквы.
  * Методы включают валидацию ключа, проверку текста, шифрование и расшифрование текста.
+ * Ошибки сообщаются исключениями `std::invalid_argument`, кроме `tryEncrypt`/`tryDecrypt`:
+ * они возвращают код результата и позицию первого недопустимого символа (CipherResult).
  *
- * @note Этот шифр подходит для работы только с русскими и английскими буквами.
+ * @note Буквы алфавита занимают в UTF-8 от одного до четырёх байт; размер буфера
+ * результата для текста в UTF-8 — utf8Capacity().
  * @date 30 ноября 2024 года
  * @version 1.0
  * @author
@@ -16,7 +20,12 @@
  */
 
 #pragma once
+#include "../common/cipherResult.h"
+#include "../common/runtimeAlphabet.h"
+#include "../common/textValidator.h"
+#include <array>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 #include <locale>
@@ -33,44 +42,426 @@
  */
 class modPermutationCipher {
 private:
-    std::wstring alphabet; ///< Алфавит, используемый для шифрования (русские и английские буквы).
+    static constexpr size_t shiftCount = 10;  ///< Число различных сдвигов: ключ состоит из цифр 0..9.
+    static constexpr size_t rowSize = Alphabet::maxSize; ///< Длина строки таблицы подстановки: любой номер буквы.
+    static constexpr size_t blockSize = 1024; ///< Количество символов, которое проверяется перед сдвигом за один шаг.
+
+    Alphabet alphabet;     ///< Алфавит шифра (таблицы общие со всеми копиями алфавита).
     std::vector<int> key;  ///< Ключ шифрования в виде вектора целых чисел.
+    std::string utf8Alpha; ///< Алфавит в UTF-8, по четыре байта на символ (у коротких лишние байты не используются).
+    std::vector<unsigned char> utf8Length; ///< Длина каждого символа алфавита в UTF-8 (1–4 байта).
+    std::array<unsigned char, shiftCount * rowSize> encryptTable; ///< Подстановка `encryptTable[shift * rowSize + index]` = (index + shift) mod N.
+    std::array<unsigned char, shiftCount * rowSize> decryptTable; ///< Обратная подстановка: (index - shift) mod N.
+    std::array<wchar_t, rowSize> alphaTable; ///< Символ по номеру; после последней буквы — L'\0'.
+
+    /**
+     * @brief Возвращает номер символа в алфавите за O(1).
+     *
+     * @param ch Символ.
+     * @return int Номер символа или `Alphabet::invalidIndex`, если символа нет в алфавите.
+     */
+    int indexOf(wchar_t ch) const {
+        return alphabet.indexOf(ch);
+    }
+
+    /**
+     * @brief Находит первый символ, не входящий в алфавит.
+     *
+     * @details Для алфавита из нескольких отрезков кодов (как русский и латинский) —
+     * общая векторная проверка (см. common/textValidator.h), иначе — по таблице номеров.
+     *
+     * @return size_t Позиция символа или `length`, если все символы допустимы.
+     */
+    size_t findInvalid(const wchar_t* text, size_t length) const noexcept;
+
+    /**
+     * @brief Проверяет и сдвигает текст без исключений.
+     *
+     * @details Текст идёт блоками по `blockSize` символов: блок проверяется сравнением
+     * с границами алфавита, затем каждый символ сдвигается одним обращением к таблице
+     * подстановки. Блоки до недопустимого символа успевают записаться в `out`.
+     *
+     * @param text Входной текст.
+     * @param length Количество символов.
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `text`).
+     * @param forward true для шифрования, false для расшифрования.
+     * @param phase Позиция ключа для первого символа.
+     * @return CipherResult Код результата, позиция ошибки и позиция ключа после текста.
+     */
+    CipherResult shift(const wchar_t* text, size_t length, wchar_t* out, bool forward, size_t phase) const noexcept;
+
+    /**
+     * @brief Проверяет и сдвигает текст, сообщая об ошибке исключением.
+     *
+     * @param text Входной текст.
+     * @param forward true для шифрования, false для расшифрования.
+     * @return std::wstring Результат той же длины.
+     * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
+     */
+    std::wstring shift(const std::wstring& text, bool forward) const;
+
+    /**
+     * @brief Сдвигает символы, стоящие в открытом тексте с постоянным шагом.
+     *
+     * @details Позиция в открытом тексте `start + k * stride` задаёт позицию ключа.
+     * При `gather` символ берётся из `text` на этой позиции и пишется в `out[k]`,
+     * иначе берётся из `text[k]` и пишется на эту позицию.
+     *
+     * @throws std::invalid_argument Если среди символов есть недопустимые.
+     */
+    template <bool gather>
+    void shiftStrided(const wchar_t* text, wchar_t* out, size_t start, size_t stride, size_t count) const;
+
+    /**
+     * @brief Сдвигает текст в UTF-8 без перевода в wchar_t.
+     *
+     * @param text Входные байты.
+     * @param length Количество байт.
+     * @param out Буфер результата не меньше `utf8Capacity(length)` байт (не может совпадать с `text`).
+     * @param forward true для шифрования, false для расшифрования.
+     * @param phase Позиция ключа; после вызова указывает на символ, следующий за последним.
+     * @param keepSpaces true — пробельные символы копируются и не сдвигают ключ;
+     * false — считаются недопустимыми, как в std::wstring-интерфейсе.
+     * @return size_t Количество записанных байт.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы.
+     */
+    size_t shiftUtf8(const char* text, size_t length, char* out, bool forward, size_t& phase,
+                     bool keepSpaces = true) const;
+
+    /**
+     * @brief То же, что shiftUtf8(), но блоки текста обрабатываются несколькими потоками.
+     *
+     * @details Блок считает свои буквы, получает позицию ключа от предыдущего блока
+     * через BlockChain (см. parallel.h) и шифруется в буфер потока, пока он ещё в кэше.
+     * Длина результата у каждого блока своя, поэтому смещение в выходном буфере
+     * передаётся по второй цепочке, и блок копируется на место, когда оно известно.
+     * Результат совпадает с последовательной обработкой.
+     *
+     * @param threads Число потоков (0 — по числу ядер).
+     */
+    size_t shiftUtf8Parallel(const char* text, size_t length, char* out, bool forward, size_t& phase,
+                             unsigned threads) const;
+
+    /**
+     * @brief Обрабатывает файл целиком через отображение в память.
+     */
+    void shiftFile(const std::string& input, const std::string& output, bool forward, unsigned threads) const;
 
 public:
     /**
      * @brief Конструктор класса.
      * 
-     * Инициализирует объект с заданным ключом.
+     * Инициализирует объект с заданным ключом и алфавитом.
      * @param skey Ключ для шифрования в формате строки.
+     * @param alphabet Алфавит шифра (по умолчанию прописные русские, затем латинские буквы).
      * @throws std::invalid_argument Если ключ некорректен.
      */
-    modPermutationCipher(const std::wstring& skey);
+    modPermutationCipher(const std::wstring& skey, const Alphabet& alphabet = Alphabet::russianLatin());
+
+    /**
+     * @brief Алфавит шифра.
+     */
+    const Alphabet& getAlphabet() const { return alphabet; }
+
+    /**
+     * @brief Размер буфера, которого хватит для результата над `length` байтами UTF-8.
+     *
+     * @details Буква результата может быть длиннее буквы входа (латинская сменяется
+     * русской), поэтому на каждый байт входа отводится наибольшая длина буквы
+     * алфавита в UTF-8: для алфавита по умолчанию — `2 * length`.
+     */
+    size_t utf8Capacity(size_t length) const { return alphabet.maxUtf8Length() * length; }
 
     /**
      * @brief Метод для шифрования текста.
      * @param open_text Открытый текст для шифрования.
      * @return std::wstring Зашифрованный текст.
      */
-    std::wstring encrypt(const std::wstring& open_text);
+    std::wstring encrypt(const std::wstring& open_text) const;
 
     /**
      * @brief Метод для расшифрования текста.
      * @param cipher_text Шифрованный текст для расшифрования.
      * @return std::wstring Расшифрованный текст.
      */
-    std::wstring decrypt(const std::wstring& cipher_text);
+    std::wstring decrypt(const std::wstring& cipher_text) const;
+
+    /**
+     * @brief Метод для шифрования текста в UTF-8.
+     *
+     * @details То же, что encrypt(const std::wstring&), но без перевода в wchar_t и обратно.
+     *
+     * @param open_text Открытый текст в UTF-8.
+     * @return std::string Зашифрованный текст в UTF-8.
+     * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
+     */
+    std::string encrypt(std::string_view open_text) const;
+
+    /**
+     * @brief Метод для расшифрования текста в UTF-8.
+     * @param cipher_text Шифрованный текст в UTF-8.
+     * @return std::string Расшифрованный текст в UTF-8.
+     * @throws std::invalid_argument Если текст пуст или содержит недопустимые символы.
+     */
+    std::string decrypt(std::string_view cipher_text) const;
+
+    /**
+     * @brief Шифрует текст в буфер вызывающей стороны без исключений.
+     *
+     * @details Недопустимый символ возвращается кодом результата: на потоке враждебного
+     * ввода не тратится время на раскрутку стека. Длинный текст можно обрабатывать
+     * частями, передавая в следующий вызов позицию ключа из результата предыдущего.
+     *
+     * @param open_text Текст для шифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `open_text`).
+     * @param phase Позиция ключа для первого символа.
+     * @return CipherResult `ok` и позиция ключа после текста или `invalidCharacter` и позиция символа.
+     */
+    CipherResult tryEncrypt(const wchar_t* open_text, size_t length, wchar_t* out, size_t phase = 0) const noexcept;
+
+    /**
+     * @brief Расшифровывает текст в буфер вызывающей стороны без исключений.
+     *
+     * @param cipher_text Текст для расшифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `cipher_text`).
+     * @param phase Позиция ключа для первого символа.
+     * @return CipherResult `ok` и позиция ключа после текста или `invalidCharacter` и позиция символа.
+     */
+    CipherResult tryDecrypt(const wchar_t* cipher_text, size_t length, wchar_t* out, size_t phase = 0) const noexcept;
+
+    /**
+     * @brief Шифрует символы, взятые из текста с постоянным шагом (сбор с подстановкой).
+     *
+     * @details `out[k]` — символ `open_text[start + k * stride]`, зашифрованный с той же
+     * позицией ключа, что и при шифровании всего текста. Так столбец таблицы маршрутной
+     * перестановки шифруется за один проход вместе с перестановкой (см. product/productCipher.h).
+     *
+     * @param open_text Открытый текст.
+     * @param start Позиция первого символа.
+     * @param stride Шаг между символами.
+     * @param count Количество символов.
+     * @param out Буфер результата не меньше `count` символов (не совпадает с `open_text`).
+     * @throws std::invalid_argument Если среди взятых символов есть недопустимые.
+     */
+    void encryptStrided(const wchar_t* open_text, size_t start, size_t stride, size_t count, wchar_t* out) const;
+
+    /**
+     * @brief Расшифровывает символы и раскладывает их по тексту с постоянным шагом.
+     *
+     * @details Обратное к encryptStrided(): `cipher_text[k]` расшифровывается с позицией
+     * ключа `start + k * stride` и записывается в `out[start + k * stride]`.
+     *
+     * @param cipher_text Шифротекст (`count` символов).
+     * @param count Количество символов.
+     * @param out Открытый текст (не совпадает с `cipher_text`).
+     * @param start Позиция первого символа в `out`.
+     * @param stride Шаг между символами в `out`.
+     * @throws std::invalid_argument Если среди символов есть недопустимые.
+     */
+    void decryptStrided(const wchar_t* cipher_text, size_t count, wchar_t* out, size_t start, size_t stride) const;
 
     /**
      * @brief Проверяет корректность ключа.
      * @param key Ключ для проверки.
      * @throws std::invalid_argument Если ключ некорректен.
      */
-    void validateKey(const std::wstring& key);
+    void validateKey(const std::wstring& key) const;
 
     /**
      * @brief Проверяет корректность текста.
      * @param text Текст для проверки.
      * @throws std::invalid_argument Если текст некорректен.
      */
-    void validateText(const std::wstring& text);
+    void validateText(const std::wstring& text) const;
+
+    /**
+     * @brief Шифрует текст в UTF-8 без перевода в wchar_t.
+     *
+     * @details Пробельные символы (пробел, табуляция, перевод строки) копируются без изменений
+     * и не сдвигают ключ. Буквы занимают от 1 до 4 байт (латинская — 1, русская — 2),
+     * поэтому длина результата может отличаться от длины входа.
+     *
+     * @param open_text Байты UTF-8.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `utf8Capacity(length)` байт.
+     * @param phase Позиция ключа для первой буквы; после вызова — для следующей.
+     * @return size_t Количество записанных байт.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы.
+     */
+    size_t encrypt(const char* open_text, size_t length, char* out, size_t& phase) const;
+
+    /**
+     * @brief Расшифровывает текст в UTF-8 без перевода в wchar_t.
+     *
+     * @param cipher_text Байты UTF-8.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `utf8Capacity(length)` байт.
+     * @param phase Позиция ключа для первой буквы; после вызова — для следующей.
+     * @return size_t Количество записанных байт.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы.
+     */
+    size_t decrypt(const char* cipher_text, size_t length, char* out, size_t& phase) const;
+
+    /**
+     * @brief Шифрует текст в UTF-8 на нескольких потоках.
+     *
+     * @details Результат побайтно совпадает с encrypt(const char*, size_t, char*, size_t&).
+     * Короткие тексты обрабатываются в вызывающем потоке.
+     *
+     * @param open_text Байты UTF-8.
+     * @param length Количество байт.
+     * @param out Буфер результата не меньше `utf8Capacity(length)` байт.
+     * @param threads Число потоков (0 — по числу ядер).
+     * @param phase Позиция ключа для первой буквы; после вызова — для следующей.
+     * @return size_t Количество записанных байт.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы.
+     */
+    size_t encryptParallel(const char* open_text, size_t length, char* out, unsigned threads, size_t& phase) const;
+
+    /**
+     * @brief Расшифровывает текст в UTF-8 на нескольких потоках.
+     *
+     * @param cipher_text Байты UTF-8.
+     * @param length Количество байт.
+     * @param out Буфер результата не меньше `utf8Capacity(length)` байт.
+     * @param threads Число потоков (0 — по числу ядер).
+     * @param phase Позиция ключа для первой буквы; после вызова — для следующей.
+     * @return size_t Количество записанных байт.
+     * @throws std::invalid_argument Если вход содержит недопустимые символы.
+     */
+    size_t decryptParallel(const char* cipher_text, size_t length, char* out, unsigned threads, size_t& phase) const;
+
+    /**
+     * @brief Шифрует файл в UTF-8, отображая вход и выход в память.
+     *
+     * @details Результат пишется во временный файл с запасом (utf8Capacity() от размера входа),
+     * который обрезается до фактического размера и заменяет выходной после успешной
+     * обработки. Выходной файл может совпадать с входным; при ошибке он не изменяется.
+     *
+     * @param input Путь к входному файлу.
+     * @param output Путь к выходному файлу.
+     * @param threads Число потоков (0 — по числу ядер).
+     * @throws std::invalid_argument Если файл содержит недопустимые символы.
+     * @throws std::runtime_error Если файл не удалось открыть, создать или отобразить.
+     */
+    void encryptFile(const std::string& input, const std::string& output, unsigned threads = 1) const;
+
+    /**
+     * @brief Расшифровывает файл в UTF-8, отображая вход и выход в память.
+     *
+     * @param input Путь к входному файлу.
+     * @param output Путь к выходному файлу.
+     * @param threads Число потоков (0 — по числу ядер).
+     * @throws std::invalid_argument Если файл содержит недопустимые символы.
+     * @throws std::runtime_error Если файл не удалось открыть, создать или отобразить.
+     */
+    void decryptFile(const std::string& input, const std::string& output, unsigned threads = 1) const;
+};
+
+/**
+ * @brief Потоковый контекст шифра: обрабатывает текст фрагментами произвольной длины.
+ *
+ * @details Объявлен для всех шифров; реализация — специализация для конкретного шифра.
+ */
+template <class Cipher>
+class CipherStream;
+
+/**
+ * @class CipherStream<modPermutationCipher>
+ * @brief Шифрование или расшифрование потока фрагментов с сохранением позиции ключа.
+ *
+ * @details Позиция ключа переносится между вызовами update(), поэтому текст, поданный
+ * любыми фрагментами, даёт тот же результат, что и один вызов над всем текстом.
+ * Сдвиг не меняет число символов, поэтому каждый фрагмент возвращается сразу,
+ * а finalize() ничего не дописывает.
+ *
+ * Во фрагментах UTF-8 многобайтовая буква может разорваться границей фрагмента: её начало
+ * (до трёх байт) хранится в контексте до следующего вызова. Пробельные символы в UTF-8
+ * копируются и не сдвигают ключ, как в encrypt(const char*, size_t, char*, size_t&).
+ */
+template <>
+class CipherStream<modPermutationCipher> {
+private:
+    modPermutationCipher cipher; ///< Копия шифра.
+    bool forward;                ///< true — шифрование, false — расшифрование.
+    size_t phase = 0;            ///< Позиция ключа для следующего символа.
+    char carry[3] = {};          ///< Начало буквы UTF-8, оборванной концом фрагмента.
+    size_t carried = 0;          ///< Сколько байт в `carry` (0 — оборванной буквы нет).
+
+    /**
+     * @brief Обрабатывает целые буквы UTF-8 и сдвигает позицию ключа `next`.
+     */
+    size_t shiftUtf8(const char* in, size_t length, char* out, size_t& next) const;
+
+public:
+    /**
+     * @brief Создаёт контекст для одного направления.
+     *
+     * @param cipher Шифр с установленным ключом.
+     * @param forward true — шифрование, false — расшифрование.
+     */
+    CipherStream(const modPermutationCipher& cipher, bool forward);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент.
+     *
+     * @param in Символы фрагмента.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (может совпадать с `in`).
+     * @return size_t Количество записанных символов (равно `length`).
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы;
+     * позиция ключа при этом не меняется.
+     */
+    size_t update(const wchar_t* in, size_t length, wchar_t* out);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент.
+     *
+     * @param fragment Фрагмент текста (допускается пустой).
+     * @return std::wstring Результат той же длины.
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы.
+     */
+    std::wstring update(const std::wstring& fragment);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент в UTF-8.
+     *
+     * @param in Байты фрагмента.
+     * @param length Количество байт (допускается 0).
+     * @param out Буфер результата не меньше `cipher.utf8Capacity(length)` байт (не может совпадать с `in`).
+     * @return size_t Количество записанных байт: оборванная в конце буква ждёт следующего фрагмента.
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы; позиция ключа
+     * и оборванная буква предыдущего фрагмента при этом не меняются, а содержимое `out` не определено.
+     */
+    size_t update(const char* in, size_t length, char* out);
+
+    /**
+     * @brief Обрабатывает очередной фрагмент в UTF-8.
+     *
+     * @param fragment Байты фрагмента.
+     * @return std::string Результат для всех целых букв фрагмента.
+     * @throws std::invalid_argument Если фрагмент содержит недопустимые символы.
+     */
+    std::string update(std::string_view fragment);
+
+    /**
+     * @brief Количество символов, которое допишет finalize() (у сдвига всегда 0).
+     */
+    size_t pending() const { return 0; }
+
+    /**
+     * @brief Завершает сообщение и готовит контекст к следующему (ключ с начала).
+     *
+     * @param out Не используется: сдвиг выдаёт результат сразу в update().
+     * @return size_t Количество записанных символов (0).
+     * @throws std::invalid_argument Если поток UTF-8 оборвался посреди буквы.
+     */
+    size_t finalize(wchar_t* out = nullptr);
+
+    /**
+     * @brief Позиция ключа для следующего символа.
+     */
+    size_t keyPhase() const { return phase; }
 };
@@ -0,0 +1,398 @@
+/**
+ * @file permutationSearch.cpp
+ * @brief Перебор ключей modPermutationCipher с оценкой по биграммам и ранним отсечением.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#include "permutationSearch.h"
+#include "../common/parallel.h"
+#include "../common/russianFrequencies.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t letterCount = BigramModel::letterCount;
+constexpr size_t shiftCount = 10;                  ///< Сдвиги одной цифры ключа: 0…9.
+constexpr size_t shiftPairs = shiftCount * shiftCount; ///< Пары сдвигов двух соседних букв.
+constexpr size_t maxDigits = 18;                   ///< 10^18 ключей ещё помещаются в uint64_t.
+constexpr size_t unitDigits = 3;                   ///< Единица работы потока — ключи с общими первыми тремя цифрами.
+
+/**
+ * @brief Номер буквы в алфавите шифра ("А…Я", затем "A…Z") без учёта регистра или -1.
+ */
+int letterIndex(unsigned long code) {
+    if (code >= L'a' && code <= L'z') {
+        code -= 0x20;
+    } else if (code >= 0x430 && code <= 0x44F) {
+        code -= 0x20;
+    } else if (code == 0x451) {
+        code = 0x401;
+    }
+    if (code >= L'A' && code <= L'Z') {
+        return static_cast<int>(33 + code - L'A');
+    }
+    if (code == 0x401) {
+        return 6; // Ё стоит после Е
+    }
+    if (code >= 0x410 && code <= 0x415) {
+        return static_cast<int>(code - 0x410);
+    }
+    if (code >= 0x416 && code <= 0x42F) {
+        return static_cast<int>(code - 0x410 + 1);
+    }
+    return -1;
+}
+
+/**
+ * @brief Буквы текста и признак "буква продолжает слово предыдущей".
+ */
+struct Letters {
+    std::vector<unsigned char> index;
+    std::vector<bool> joined;
+
+    void add(int letter, bool& inWord) {
+        index.push_back(static_cast<unsigned char>(letter));
+        joined.push_back(inWord);
+        inWord = true;
+    }
+};
+
+/**
+ * @brief Разбирает UTF-8: буквы алфавита по номерам, прочие символы разделяют слова.
+ *
+ * @param limit Сколько букв собрать (0 — все).
+ */
+Letters readLetters(std::string_view text, size_t limit) {
+    Letters letters;
+    bool inWord = false;
+    for (size_t i = 0; i < text.size() && (limit == 0 || letters.index.size() < limit);) {
+        const unsigned char lead = static_cast<unsigned char>(text[i]);
+        unsigned long code = lead;
+        size_t width = 1;
+        if ((lead & 0xE0) == 0xC0 && i + 1 < text.size()) {
+            code = ((lead & 0x1Ful) << 6) | (static_cast<unsigned char>(text[i + 1]) & 0x3F);
+            width = 2;
+        }
+        const int letter = letterIndex(code);
+        if (letter >= 0) {
+            letters.add(letter, inWord);
+        } else {
+            inWord = false;
+        }
+        i += width;
+    }
+    return letters;
+}
+
+/**
+ * @brief Найденный ключ в потоке перебора.
+ */
+struct Found {
+    float score;
+    std::uint64_t index; ///< Номер ключа в общей нумерации (для однозначного порядка при равных оценках).
+    size_t length;
+    std::array<unsigned char, maxDigits> digits;
+};
+
+bool better(const Found& a, const Found& b) {
+    return a.score > b.score || (a.score == b.score && a.index < b.index);
+}
+
+/**
+ * @brief Повторяет ли ключ более короткий ключ (или состоит из одного нуля).
+ */
+bool redundant(const unsigned char* digits, size_t length) {
+    if (length == 1) {
+        return digits[0] == 0;
+    }
+    for (size_t period = 1; period < length; period++) {
+        if (length % period != 0) {
+            continue;
+        }
+        size_t i = period;
+        while (i < length && digits[i] == digits[i - period]) {
+            i++;
+        }
+        if (i == length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Оценки пар соседних букв, сложенные по столбцам ключа одной длины.
+ *
+ * @details Соседние буквы сдвигаются соседними цифрами ключа (j и j + 1 mod L), поэтому
+ * оценки всех пар, первая буква которых стоит в столбце j, складываются в одну таблицу
+ * 10×10, и пробная расшифровка всего начала текста — это сумма L чисел.
+ */
+struct LengthTables {
+    std::vector<float> pairs; ///< `pairs[j * 100 + s1 * 10 + s2]` для столбцов j и j + 1 mod L.
+    std::vector<float> rest;  ///< `rest[i]` — наибольшая сумма таблиц i…L-1.
+};
+
+/**
+ * @brief Перебор одного потока: обход цифр ключа в глубину с отсечением поддеревьев.
+ *
+ * @details Когда заданы цифры 0…i, известны оценки столбцов 0…i-1; если даже
+ * с наибольшими оценками остальных столбцов ключ не попадает в `top` лучших,
+ * пропускаются сразу все 10^(L-1-i) ключей с этим началом.
+ */
+class Searcher {
+private:
+    const LengthTables* tables = nullptr;
+    size_t length = 0;
+    std::uint64_t first = 0; ///< Номер первого ключа текущей длины.
+    std::array<unsigned char, maxDigits> digits{};
+    const std::uint64_t* power;
+    size_t top;
+    bool earlyAbort;
+    float threshold = -std::numeric_limits<float>::infinity();
+
+    float term(size_t column, size_t next) const {
+        return tables->pairs[column * shiftPairs + digits[column] * shiftCount + digits[next]];
+    }
+
+    bool pruned(float partial, size_t level) {
+        if (earlyAbort && best.size() == top && partial + tables->rest[level] < threshold) {
+            prunedKeys += power[length - 1 - level];
+            return true;
+        }
+        return false;
+    }
+
+    void consider(float score, std::uint64_t number) {
+        if (score < threshold || redundant(digits.data(), length)) {
+            return;
+        }
+        const Found candidate{score, first + number, length, digits};
+        if (best.size() == top && !better(candidate, best.back())) {
+            return;
+        }
+        best.insert(std::upper_bound(best.begin(), best.end(), candidate, better), candidate);
+        if (best.size() > top) {
+            best.pop_back();
+        }
+        if (best.size() == top) {
+            threshold = best.back().score;
+        }
+    }
+
+    void descend(size_t level, float partial, std::uint64_t number) {
+        if (level == length) {
+            consider(partial + term(length - 1, 0), number);
+            return;
+        }
+        for (unsigned char digit = 0; digit < shiftCount; digit++) {
+            digits[level] = digit;
+            const float known = partial + term(level - 1, level);
+            if (!pruned(known, level)) {
+                descend(level + 1, known, number * shiftCount + digit);
+            }
+        }
+    }
+
+public:
+    std::vector<Found> best;      ///< Лучшие ключи потока по убыванию оценки.
+    std::uint64_t prunedKeys = 0; ///< Ключи, отброшенные без полной оценки.
+
+    Searcher(const std::uint64_t* power, size_t top, bool earlyAbort)
+        : power(power), top(top), earlyAbort(earlyAbort) {}
+
+    /**
+     * @brief Перебирает ключи длины `keyLength`, начинающиеся с `lead` (`leadDigits` цифр).
+     */
+    void run(const LengthTables& lengthTables, size_t keyLength, std::uint64_t firstKey, std::uint64_t lead,
+             size_t leadDigits) {
+        tables = &lengthTables;
+        length = keyLength;
+        first = firstKey;
+        std::uint64_t value = lead;
+        for (size_t j = leadDigits; j-- > 0; value /= shiftCount) {
+            digits[j] = static_cast<unsigned char>(value % shiftCount);
+        }
+        float partial = 0;
+        for (size_t j = 1; j < leadDigits; j++) {
+            partial += term(j - 1, j);
+        }
+        if (!pruned(partial, leadDigits - 1)) {
+            descend(leadDigits, partial, lead);
+        }
+    }
+};
+
+/**
+ * @brief Перебор по подготовленному началу шифротекста.
+ */
+SearchResult searchLetters(const Letters& letters, const BigramModel& model, const SearchOptions& options) {
+    if (options.maxKeyLength == 0 || options.maxKeyLength > maxDigits) {
+        throw std::invalid_argument("Ошибка: длина ключа для перебора должна быть от 1 до 18.");
+    }
+    if (options.top == 0) {
+        throw std::invalid_argument("Ошибка: число лучших ключей должно быть положительным.");
+    }
+    const size_t maxLength = options.maxKeyLength;
+
+    // Пары соседних букв внутри слов: номер первой буквы и номера обеих букв шифротекста.
+    std::vector<size_t> positions;
+    for (size_t i = 1; i < letters.index.size(); i++) {
+        if (letters.joined[i]) {
+            positions.push_back(i - 1);
+        }
+    }
+    if (positions.empty()) {
+        throw std::invalid_argument("Ошибка: в начале шифротекста нет соседних букв для оценки ключа.");
+    }
+
+    // Таблицы для каждой длины: сначала число пар букв каждого вида в каждом столбце,
+    // затем оценка вида пары для всех 100 пар сдвигов.
+    std::vector<LengthTables> tables(maxLength + 1);
+    std::vector<unsigned> counts;
+    for (size_t length = 1; length <= maxLength; length++) {
+        counts.assign(length * letterCount * letterCount, 0);
+        for (size_t position : positions) {
+            counts[(position % length * letterCount + letters.index[position]) * letterCount
+                   + letters.index[position + 1]]++;
+        }
+        LengthTables& table = tables[length];
+        table.pairs.assign(length * shiftPairs, 0.0f);
+        for (size_t column = 0; column < length; column++) {
+            for (size_t pair = 0; pair < letterCount * letterCount; pair++) {
+                const unsigned count = counts[column * letterCount * letterCount + pair];
+                if (count == 0) {
+                    continue;
+                }
+                const size_t c1 = pair / letterCount;
+                const size_t c2 = pair % letterCount;
+                for (size_t s1 = 0; s1 < shiftCount; s1++) {
+                    for (size_t s2 = 0; s2 < shiftCount; s2++) {
+                        table.pairs[column * shiftPairs + s1 * shiftCount + s2] +=
+                            count * model.logProb((c1 + letterCount - s1) % letterCount,
+                                                  (c2 + letterCount - s2) % letterCount);
+                    }
+                }
+            }
+        }
+        table.rest.assign(length + 1, 0.0f);
+        for (size_t column = length; column-- > 0;) {
+            const auto begin = table.pairs.begin() + column * shiftPairs;
+            table.rest[column] = table.rest[column + 1] + *std::max_element(begin, begin + shiftPairs);
+        }
+    }
+
+    // Единицы работы: длина ключа и значение первых (до unitDigits) цифр.
+    std::array<std::uint64_t, maxDigits + 1> power;
+    power[0] = 1;
+    for (size_t i = 1; i <= maxDigits; i++) {
+        power[i] = power[i - 1] * shiftCount;
+    }
+    std::vector<std::uint64_t> firstKey(maxLength + 2, 0);  ///< Номер первого ключа каждой длины.
+    std::vector<std::uint64_t> firstUnit(maxLength + 2, 0); ///< Номер первой единицы работы каждой длины.
+    for (size_t length = 1; length <= maxLength; length++) {
+        firstKey[length + 1] = firstKey[length] + power[length];
+        firstUnit[length + 1] = firstUnit[length] + power[std::min(length, unitDigits)];
+    }
+    const std::uint64_t units = firstUnit[maxLength + 1];
+
+    unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::uint64_t>(threads, units));
+    std::atomic<std::uint64_t> nextUnit{0};
+    std::vector<Searcher> searchers(threads, Searcher(power.data(), options.top, options.earlyAbort));
+    runParallel(threads, [&](unsigned part) {
+        Searcher& searcher = searchers[part];
+        size_t length = 1;
+        for (std::uint64_t unit; (unit = nextUnit.fetch_add(1, std::memory_order_relaxed)) < units;) {
+            while (firstUnit[length + 1] <= unit) {
+                length++;
+            }
+            searcher.run(tables[length], length, firstKey[length], unit - firstUnit[length],
+                         std::min(length, unitDigits));
+        }
+    });
+
+    std::vector<Found> all;
+    SearchResult result;
+    for (const Searcher& searcher : searchers) {
+        all.insert(all.end(), searcher.best.begin(), searcher.best.end());
+        result.keysPruned += searcher.prunedKeys;
+    }
+    std::sort(all.begin(), all.end(), better);
+    all.resize(std::min(all.size(), options.top));
+    for (const Found& candidate : all) {
+        std::wstring key(candidate.length, L'0');
+        for (size_t j = 0; j < candidate.length; j++) {
+            key[j] = static_cast<wchar_t>(L'0' + candidate.digits[j]);
+        }
+        result.candidates.push_back(KeyCandidate{key, static_cast<double>(candidate.score) / positions.size()});
+    }
+    result.keysTried = firstKey[maxLength + 1];
+    result.pairs = positions.size();
+    return result;
+}
+
+} // namespace
+
+BigramModel::BigramModel(std::string_view sample) {
+    const Letters letters = readLetters(sample, 0);
+    std::vector<double> counts(letterCount * letterCount, 0.5);
+    size_t pairs = 0;
+    for (size_t i = 1; i < letters.index.size(); i++) {
+        if (letters.joined[i]) {
+            counts[letters.index[i - 1] * letterCount + letters.index[i]] += 1;
+            pairs++;
+        }
+    }
+    if (pairs == 0) {
+        throw std::invalid_argument("Ошибка: в образце текста нет ни одной пары букв.");
+    }
+    const double total = pairs + 0.5 * counts.size();
+    for (size_t i = 0; i < counts.size(); i++) {
+        table[i] = static_cast<float>(std::log(counts[i] / total));
+    }
+}
+
+BigramModel BigramModel::russian() {
+    constexpr double latinFrequency = 1e-4;
+    std::array<double, letterCount> frequency;
+    std::fill(frequency.begin(), frequency.end(), latinFrequency);
+    std::copy(russianFrequencies.begin(), russianFrequencies.end(), frequency.begin());
+    double total = 0;
+    for (double f : frequency) {
+        total += f;
+    }
+    BigramModel model;
+    for (size_t first = 0; first < letterCount; first++) {
+        for (size_t second = 0; second < letterCount; second++) {
+            model.table[first * letterCount + second] =
+                static_cast<float>(std::log(frequency[first] / total) + std::log(frequency[second] / total));
+        }
+    }
+    return model;
+}
+
+SearchResult searchPermutationKey(std::string_view ciphertext, const BigramModel& model, const SearchOptions& options) {
+    return searchLetters(readLetters(ciphertext, options.prefixLetters), model, options);
+}
+
+SearchResult searchPermutationKey(const std::wstring& ciphertext, const BigramModel& model,
+                                  const SearchOptions& options) {
+    Letters letters;
+    bool inWord = false;
+    for (size_t i = 0; i < ciphertext.size()
+                       && (options.prefixLetters == 0 || letters.index.size() < options.prefixLetters); i++) {
+        const int letter = letterIndex(static_cast<unsigned long>(ciphertext[i]));
+        if (letter >= 0) {
+            letters.add(letter, inWord);
+        } else {
+            inWord = false;
+        }
+    }
+    return searchLetters(letters, model, options);
+}
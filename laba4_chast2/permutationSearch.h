@@ -0,0 +1,124 @@
+/**
+ * @file permutationSearch.h
+ * @brief Перебор ключей modPermutationCipher по шифротексту.
+ *
+ * @details
+ * Ключ шифра — строка цифр, каждая цифра сдвигает букву на 0…9 позиций, поэтому
+ * ключей длины `L` всего `10^L`, и полный перебор коротких ключей реален.
+ * Каждый ключ проверяется только на начале шифротекста (`prefixLetters` букв):
+ * 1. Соседние буквы сдвигаются соседними цифрами ключа, поэтому для каждой длины ключа
+ *    заранее считается таблица: для столбцов j, j + 1 и каждой пары сдвигов (s1, s2) —
+ *    сумма логарифмов вероятностей биграмм расшифрованных букв по всем таким парам.
+ *    Пробная расшифровка начала любой длины стоит L обращений к таблице.
+ * 2. Цифры ключа перебираются в глубину. Как только даже наилучшие оценки оставшихся
+ *    столбцов не поднимают ключ до худшего из `top` лучших, пропускаются все ключи
+ *    с этим началом (отсечение точное: пропущенный ключ не мог попасть в ответ).
+ * 3. Единица работы — ключи одной длины с общими первыми тремя цифрами; потоки
+ *    забирают следующую единицу из общего атомарного счётчика, поэтому освободившийся
+ *    поток сразу берёт новую работу.
+ *
+ * Пары букв через пробел не оцениваются: биграммы считаются только внутри слов.
+ * Ключи, повторяющие более короткий ключ ("1212" = "12"), и ключ из одних нулей
+ * в ответ не попадают.
+ *
+ * @author
+ * Бренинг И. А.
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class BigramModel
+ * @brief Логарифмы вероятностей биграмм над алфавитом шифра (33 русские и 26 латинских букв).
+ */
+class BigramModel {
+public:
+    static constexpr size_t letterCount = 59; ///< Размер алфавита modPermutationCipher.
+
+    /**
+     * @brief Обучает модель на образце текста в UTF-8.
+     *
+     * @details Строчные буквы приводятся к заглавным, пары считаются только внутри слов.
+     * К каждой паре добавляется 0,5, чтобы невстреченные биграммы не давали −∞.
+     *
+     * @param sample Образец текста на языке открытого текста.
+     * @throws std::invalid_argument Если в образце нет ни одной пары букв.
+     */
+    explicit BigramModel(std::string_view sample);
+
+    /**
+     * @brief Модель по умолчанию для русского текста.
+     *
+     * @details Построена по частотам отдельных букв (биграмма — произведение частот),
+     * латинские буквы считаются редкими. Для другого языка модель лучше обучить
+     * на образце текста.
+     */
+    static BigramModel russian();
+
+    /**
+     * @brief Логарифм вероятности биграммы `first`, `second` (номера букв алфавита шифра).
+     */
+    float logProb(size_t first, size_t second) const { return table[first * letterCount + second]; }
+
+private:
+    BigramModel() = default;
+
+    std::array<float, letterCount * letterCount> table{}; ///< `table[first * letterCount + second]`.
+};
+
+/**
+ * @brief Параметры перебора.
+ */
+struct SearchOptions {
+    size_t maxKeyLength = 6;    /**< Наибольшая длина ключа (перебираются длины 1…maxKeyLength, не больше 18). */
+    size_t prefixLetters = 256; /**< Сколько первых букв шифротекста расшифровывается для оценки (0 — все). */
+    size_t top = 5;             /**< Сколько лучших ключей вернуть. */
+    unsigned threads = 0;       /**< Число потоков (0 — по числу ядер). */
+    bool earlyAbort = true;     /**< Пропускать ключи, которые не могут попасть в ответ. */
+};
+
+/**
+ * @brief Ключ-кандидат.
+ */
+struct KeyCandidate {
+    std::wstring key; /**< Ключ из цифр. */
+    double score;     /**< Средний логарифм вероятности биграммы в расшифрованном начале. */
+};
+
+/**
+ * @brief Результат перебора.
+ */
+struct SearchResult {
+    std::vector<KeyCandidate> candidates; /**< Лучшие ключи по убыванию оценки. */
+    std::uint64_t keysTried = 0;          /**< Перебрано ключей. */
+    std::uint64_t keysPruned = 0;         /**< Из них пропущено отсечением без полной оценки. */
+    size_t pairs = 0;                     /**< Число оцениваемых пар букв. */
+};
+
+/**
+ * @brief Ищет ключ modPermutationCipher по шифротексту в UTF-8.
+ *
+ * @details Шифротекст должен начинаться с начала сообщения (позиция ключа 0).
+ * Все символы, кроме букв алфавита, разделяют слова и не сдвигают ключ.
+ *
+ * @param ciphertext Шифротекст.
+ * @param model Модель языка открытого текста.
+ * @param options Параметры перебора.
+ * @return SearchResult Лучшие ключи и счётчики перебора.
+ * @throws std::invalid_argument Если в начале текста нет ни одной пары соседних букв
+ * или параметры некорректны.
+ */
+SearchResult searchPermutationKey(std::string_view ciphertext, const BigramModel& model,
+                                  const SearchOptions& options = SearchOptions());
+
+/**
+ * @brief То же для шифротекста в wchar_t (без пробелов, как в std::wstring-интерфейсе шифра).
+ */
+SearchResult searchPermutationKey(const std::wstring& ciphertext, const BigramModel& model,
+                                  const SearchOptions& options = SearchOptions());
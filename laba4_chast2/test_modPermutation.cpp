@@ -0,0 +1,430 @@
+#include <UnitTest++/UnitTest++.h>
+#include "modPermutation.h"
+#include "../common/metrics.h"
+#include "../common/russianFrequencies.h"
+#include "permutationSearch.h"
+#include <codecvt>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <locale>
+#include <random>
+#include <thread>
+
+std::string wstring_to_string(const std::wstring& wstr) {
+    std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+    return converter.to_bytes(wstr);
+}
+
+TEST(TestConstructorValidKey) {
+    modPermutationCipher cipher(L"123");
+    CHECK(true);
+}
+
+TEST(TestConstructorInvalidKeyNonDigit) {
+    CHECK_THROW(modPermutationCipher(L"бкд"), std::invalid_argument);
+}
+
+TEST(TestConstructorEmptyKey) {
+    CHECK_THROW(modPermutationCipher(L""), std::invalid_argument);
+}
+
+TEST(TestZeroKey) {
+    CHECK_THROW(modPermutationCipher(L"0"), std::invalid_argument);
+    CHECK_THROW(modPermutationCipher(L"000"), std::invalid_argument);
+}
+
+TEST(TestLongKey) {
+    modPermutationCipher cipher(std::wstring(4096, L'7'));
+    CHECK_EQUAL(wstring_to_string(cipher.encrypt(L"АБВ")), "ЖЗИ");
+}
+
+TEST(TestEncryptEmptyText) {
+    modPermutationCipher cipher(L"123");
+    CHECK_THROW(cipher.encrypt(L""), std::invalid_argument);
+}
+
+TEST(TestEncryptLowerCaseText) {
+    modPermutationCipher cipher(L"123");
+    CHECK_THROW(cipher.encrypt(L"бгеж"), std::invalid_argument);
+}
+
+TEST(TestEncryptValidText) {
+    modPermutationCipher cipher(L"123");
+    CHECK_EQUAL(wstring_to_string(cipher.encrypt(L"БГЕЖ")), "ВЕЗЗ");
+}
+
+TEST(TestDecryptValidText) {
+    modPermutationCipher cipher(L"123");
+    CHECK_EQUAL(wstring_to_string(cipher.decrypt(L"ВЕЗЗ")), "БГЕЖ");
+}
+
+TEST(TestEncryptWrapsToLatin) {
+    modPermutationCipher cipher(L"2");
+    CHECK_EQUAL(wstring_to_string(cipher.encrypt(L"ЯZ")), "BБ");
+    CHECK_EQUAL(wstring_to_string(cipher.decrypt(L"BБ")), "ЯZ");
+}
+
+TEST(TestLongTextMatchesAlphabetShift) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::mt19937 gen(4);
+    std::wstring text(5000, L' ');
+    for (auto& c : text) {
+        c = alphabet[gen() % alphabet.size()];
+    }
+    modPermutationCipher cipher(L"90317");
+    const int key[] = {9, 0, 3, 1, 7};
+    std::wstring encrypted = cipher.encrypt(text);
+    for (size_t i = 0; i < text.size(); i++) {
+        CHECK(encrypted[i] == alphabet[(alphabet.find(text[i]) + key[i % 5]) % alphabet.size()]);
+    }
+    CHECK(cipher.decrypt(encrypted) == text);
+    text[4321] = L'ж';
+    CHECK_THROW(cipher.encrypt(text), std::invalid_argument);
+}
+
+TEST(TestTryEncryptReportsOffset) {
+    modPermutationCipher cipher(L"90317");
+    std::wstring text(3000, L'Ж');
+    std::wstring out(text.size(), L'\0');
+    CipherResult result = cipher.tryEncrypt(text.data(), text.size(), &out[0], 2);
+    CHECK(result);
+    CHECK_EQUAL(result.phase, 2u);
+    std::wstring back(text.size(), L'\0');
+    size_t phase = cipher.tryDecrypt(out.data(), 1000, &back[0], 2).phase;
+    CHECK(cipher.tryDecrypt(out.data() + 1000, 2000, &back[1000], phase));
+    CHECK(back == text);
+
+    text[2049] = L'ж';
+    result = cipher.tryEncrypt(text.data(), text.size(), &out[0]);
+    CHECK(result.status == CipherStatus::invalidCharacter);
+    CHECK_EQUAL(result.offset, 2049u);
+}
+
+TEST(TestTryEncryptAcceptsExactlyAlphabet) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    modPermutationCipher cipher(L"1");
+    wchar_t out;
+    for (wchar_t c = 0; c < 0x600; c++) {
+        CHECK_EQUAL(static_cast<bool>(cipher.tryEncrypt(&c, 1, &out)), alphabet.find(c) != std::wstring::npos);
+    }
+}
+
+TEST(TestEncryptUtf8MatchesWide) {
+    modPermutationCipher cipher(L"90317");
+    const std::wstring text = L"СЪЕШЬЕЩЁЭТИХМЯГКИХФРАНЦУЗСКИХБУЛОКQUICKBROWNFOX";
+    const std::string bytes = wstring_to_string(text);
+    std::string out(2 * bytes.size(), '\0');
+    size_t phase = 0;
+    out.resize(cipher.encrypt(bytes.data(), bytes.size(), &out[0], phase));
+    CHECK_EQUAL(out, wstring_to_string(cipher.encrypt(text)));
+    CHECK_EQUAL(phase, text.size() % 5);
+}
+
+TEST(TestEncryptUtf8KeepsSpaces) {
+    modPermutationCipher cipher(L"123");
+    const std::string text = "БГ ЕЖ\n";
+    std::string out(2 * text.size(), '\0');
+    size_t phase = 0;
+    out.resize(cipher.encrypt(text.data(), text.size(), &out[0], phase));
+    CHECK_EQUAL(out, std::string("ВЕ ЗЗ\n"));
+}
+
+TEST(TestEncryptUtf8InvalidText) {
+    modPermutationCipher cipher(L"123");
+    std::string out(16, '\0');
+    size_t phase = 0;
+    CHECK_THROW(cipher.encrypt("hello", 5, &out[0], phase), std::invalid_argument);
+    CHECK_THROW(cipher.encrypt("Б\xD0", 3, &out[0], phase), std::invalid_argument);
+}
+
+TEST(TestEncryptFile) {
+    modPermutationCipher cipher(L"123");
+    std::ofstream("test_input.txt") << "БГЕЖ\n";
+    cipher.encryptFile("test_input.txt", "test_output.txt");
+    std::ifstream result("test_output.txt");
+    std::string text((std::istreambuf_iterator<char>(result)), std::istreambuf_iterator<char>());
+    CHECK_EQUAL(text, std::string("ВЕЗЗ\n"));
+    std::remove("test_input.txt");
+    std::remove("test_output.txt");
+}
+
+TEST(TestEncryptFileInPlace) {
+    modPermutationCipher cipher(L"123");
+    std::ofstream("test_inplace.txt") << "БГЕЖ\n";
+    cipher.encryptFile("test_inplace.txt", "test_inplace.txt");
+    {
+        std::ifstream result("test_inplace.txt");
+        std::string text((std::istreambuf_iterator<char>(result)), std::istreambuf_iterator<char>());
+        CHECK_EQUAL(text, std::string("ВЕЗЗ\n"));
+    }
+    // При ошибке выходной файл остаётся прежним.
+    std::ofstream("test_input.txt") << "БГЕЖ hello\n";
+    CHECK_THROW(cipher.encryptFile("test_input.txt", "test_inplace.txt"), std::invalid_argument);
+    std::ifstream result("test_inplace.txt");
+    std::string text((std::istreambuf_iterator<char>(result)), std::istreambuf_iterator<char>());
+    CHECK_EQUAL(text, std::string("ВЕЗЗ\n"));
+    std::remove("test_input.txt");
+    std::remove("test_inplace.txt");
+}
+
+TEST(TestEncryptUtf8String) {
+    modPermutationCipher cipher(L"123");
+    CHECK_EQUAL(cipher.encrypt(std::string_view("БГЕЖ")), std::string("ВЕЗЗ"));
+    CHECK_EQUAL(cipher.decrypt(std::string_view("ВЕЗЗ")), std::string("БГЕЖ"));
+    CHECK_THROW(cipher.encrypt(std::string_view("")), std::invalid_argument);
+    CHECK_THROW(cipher.encrypt(std::string_view("БГ ЕЖ")), std::invalid_argument);
+}
+
+TEST(TestEncryptParallelMatchesSerial) {
+    const std::string letters[] = {"А", "Ё", "Я", "Ж", "A", "Q", "Z", " ", "\n"};
+    std::mt19937 gen(3);
+    std::string text;
+    while (text.size() < 1000000) {
+        text += letters[gen() % 9];
+    }
+    modPermutationCipher cipher(L"90317");
+    std::string serial(2 * text.size(), '\0');
+    std::string parallel(2 * text.size(), '\0');
+    size_t serialPhase = 2;
+    size_t parallelPhase = 2;
+    serial.resize(cipher.encrypt(text.data(), text.size(), &serial[0], serialPhase));
+    parallel.resize(cipher.encryptParallel(text.data(), text.size(), &parallel[0], 6, parallelPhase));
+    CHECK(parallel == serial);
+    CHECK_EQUAL(parallelPhase, serialPhase);
+    std::string back(2 * parallel.size(), '\0');
+    parallelPhase = 2;
+    back.resize(cipher.decryptParallel(parallel.data(), parallel.size(), &back[0], 5, parallelPhase));
+    CHECK(back == text);
+    // Ошибка в одном из последних блоков не должна оставлять ждущие потоки.
+    text[900001] = 'x';
+    parallel.resize(2 * text.size());
+    CHECK_THROW(cipher.encryptParallel(text.data(), text.size(), &parallel[0], 6, parallelPhase),
+                std::invalid_argument);
+}
+
+TEST(TestCipherStreamMatchesWholeText) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::mt19937 gen(18);
+    std::wstring text(5000, L' ');
+    for (auto& c : text) {
+        c = alphabet[gen() % alphabet.size()];
+    }
+    const modPermutationCipher cipher(L"90317");
+    const std::wstring expected = cipher.encrypt(text);
+    CipherStream<modPermutationCipher> encryptor(cipher, true);
+    std::wstring encrypted;
+    for (size_t pos = 0; pos < text.size();) {
+        const size_t n = std::min<size_t>(gen() % 40, text.size() - pos);
+        encrypted += encryptor.update(text.substr(pos, n));
+        pos += n;
+    }
+    CHECK_EQUAL(encryptor.finalize(), 0u);
+    CHECK(encrypted == expected);
+    CHECK_THROW(encryptor.update(L"Аб"), std::invalid_argument);
+
+    // Фрагменты UTF-8 режутся по любому байту, в том числе посреди русской буквы.
+    const std::string bytes = wstring_to_string(expected);
+    CipherStream<modPermutationCipher> decryptor(cipher, false);
+    std::string back;
+    for (size_t pos = 0; pos < bytes.size();) {
+        const size_t n = std::min<size_t>(gen() % 40, bytes.size() - pos);
+        back += decryptor.update(std::string_view(bytes).substr(pos, n));
+        pos += n;
+    }
+    decryptor.finalize();
+    CHECK(back == wstring_to_string(text));
+    decryptor.update(std::string_view("A\xD0"));
+    CHECK_THROW(decryptor.finalize(), std::invalid_argument);
+
+    // Ошибка во фрагменте не сдвигает ключ и не теряет оборванную букву предыдущего фрагмента.
+    const modPermutationCipher shortKey(L"123");
+    const std::string cipherText = "ВЕЗЗ";
+    CipherStream<modPermutationCipher> resumed(shortKey, false);
+    CHECK_EQUAL(resumed.update(std::string_view(cipherText).substr(0, 3)), std::string("Б"));
+    CHECK_THROW(resumed.update(std::string_view(cipherText.substr(3, 1) + "x")), std::invalid_argument);
+    CHECK_EQUAL(resumed.update(std::string_view(cipherText).substr(3)), std::string("ГЕЖ"));
+    CHECK_EQUAL(resumed.finalize(), 0u);
+}
+
+TEST(TestMetricsSnapshot) {
+    const MetricsSnapshot before = collectMetrics();
+    const modPermutationCipher cipher(L"90317");
+    cipher.encrypt(std::wstring(L"БГЕЖ"));
+    CHECK_THROW(cipher.encrypt(std::wstring(L"Аб")), std::invalid_argument);
+    std::string out(8, '\0');
+    size_t phase = 0;
+    std::thread([&] { cipher.encrypt("AB C", 4, &out[0], phase); }).join();
+    const MetricsSnapshot after = collectMetrics();
+    if (after.enabled) {
+        CHECK_EQUAL(after[MetricCounter::calls] - before[MetricCounter::calls], 3u);
+        CHECK_EQUAL(after[MetricCounter::bytes] - before[MetricCounter::bytes], 6 * sizeof(wchar_t) + 4);
+        CHECK_EQUAL(after[MetricCounter::rejections] - before[MetricCounter::rejections], 1u);
+        CHECK_EQUAL(after[MetricCounter::allocations] - before[MetricCounter::allocations], 2u);
+    } else {
+        CHECK_EQUAL(after[MetricCounter::calls], 0u);
+    }
+    CHECK(formatMetrics(after, MetricsFormat::prometheus).find("cipher_rejections_total ") != std::string::npos);
+}
+
+TEST(TestSearchFindsKey) {
+    // Буквы с частотами русского текста, через 5 букв — пробел.
+    std::mt19937 gen(22);
+    const std::string text = wstring_to_string(russianText(3000, 5, gen));
+    std::string encrypted(2 * text.size(), '\0');
+    size_t phase = 0;
+    encrypted.resize(modPermutationCipher(L"3907").encrypt(text.data(), text.size(), &encrypted[0], phase));
+
+    SearchOptions options;
+    options.maxKeyLength = 4;
+    options.prefixLetters = 1200;
+    options.top = 3;
+    options.threads = 1;
+    const SearchResult serial = searchPermutationKey(encrypted, BigramModel::russian(), options);
+    CHECK_EQUAL(serial.keysTried, 11110u);
+    CHECK(serial.keysPruned > 0);
+    CHECK_EQUAL(serial.candidates.size(), 3u);
+    CHECK(serial.candidates[0].key == L"3907");
+    CHECK(serial.candidates[0].score > serial.candidates[1].score);
+
+    // Отсечение и число потоков не меняют ответ.
+    options.threads = 3;
+    options.earlyAbort = false;
+    const SearchResult full = searchPermutationKey(encrypted, BigramModel::russian(), options);
+    CHECK_EQUAL(full.keysPruned, 0u);
+    for (size_t i = 0; i < 3; i++) {
+        CHECK(full.candidates[i].key == serial.candidates[i].key);
+        CHECK_EQUAL(full.candidates[i].score, serial.candidates[i].score);
+    }
+
+    const BigramModel trained(text);
+    CHECK(trained.logProb(15, 0) > trained.logProb(27, 27)); // "ОА" чаще, чем "ЪЪ"
+    CHECK_THROW(BigramModel("А Б В"), std::invalid_argument);
+    CHECK_THROW(searchPermutationKey(std::string("А, Б"), trained), std::invalid_argument);
+}
+
+TEST(TestAlphabetFromFile) {
+    std::ofstream("test_alphabet.txt") << "# греческий алфавит\nΑΒΓΔΕΖΗΘΙΚΛΜ\n  ΝΞΟΠΡΣΤΥΦΧΨΩ\n";
+    const Alphabet greek = Alphabet::fromFile("test_alphabet.txt");
+    std::remove("test_alphabet.txt");
+    CHECK_EQUAL(greek.size(), 24u);
+    CHECK(greek == Alphabet(L"ΑΒΓΔΕΖΗΘΙΚΛΜΝΞΟΠΡΣΤΥΦΧΨΩ"));
+    modPermutationCipher cipher(L"123", greek);
+    CHECK(cipher.encrypt(L"ΑΛΦΩ") == L"ΒΝΩΑ");
+    CHECK(cipher.decrypt(L"ΒΝΩΑ") == L"ΑΛΦΩ");
+    CHECK_THROW(cipher.encrypt(L"ΑΛΦA"), std::invalid_argument);
+    CHECK_EQUAL(cipher.encrypt(std::string_view("ΑΛΦΩΑ")), std::string("ΒΝΩΑΓ"));
+    CHECK(modPermutationCipher(L"1").getAlphabet() == Alphabet::russianLatin());
+}
+
+TEST(TestAlphabetInvalid) {
+    CHECK_THROW(Alphabet(L""), std::invalid_argument);
+    CHECK_THROW(Alphabet(L"АБА"), std::invalid_argument);
+    CHECK_THROW(Alphabet(L"А Б"), std::invalid_argument);
+    CHECK_THROW(Alphabet(std::wstring(257, L'А')), std::invalid_argument);
+    CHECK_THROW(Alphabet::fromUtf8("\xD0"), std::invalid_argument);
+    CHECK_THROW(Alphabet::fromFile("test_no_such_alphabet.txt"), std::runtime_error);
+}
+
+TEST(TestAlphabetFullAndScattered) {
+    // 256 букв: номер 255 — обычная буква, а не метка недопустимого символа.
+    std::wstring letters;
+    for (wchar_t c = 0x100; c < 0x200; c++) {
+        letters += c;
+    }
+    const Alphabet full(letters);
+    CHECK_EQUAL(full.indexOf(L'\u01FF'), 255);
+    CHECK_EQUAL(full.indexOf(L'\u0200'), Alphabet::invalidIndex);
+    const modPermutationCipher fullCipher(L"9", full);
+    CHECK(fullCipher.encrypt(std::wstring(1, L'\u01FF')) == std::wstring(1, L'\u0108'));
+    CHECK(fullCipher.decrypt(fullCipher.encrypt(letters)) == letters);
+
+    // Коды разбросаны по Юникоду (двухуровневая таблица), сдвиг больше размера алфавита.
+    const Alphabet scattered(L"A\u4E2D\U0001F600");
+    CHECK_EQUAL(scattered.indexOf(L'\U0001F600'), 2);
+    CHECK_EQUAL(scattered.indexOf(L'\U0001F601'), Alphabet::invalidIndex);
+    CHECK_EQUAL(scattered.indexOf(L'B'), Alphabet::invalidIndex);
+    const modPermutationCipher cipher(L"97", scattered);
+    const std::wstring text = L"A\U0001F600\u4E2DAA";
+    CHECK(cipher.encrypt(text) == L"AA\u4E2D\u4E2DA");
+    CHECK(cipher.decrypt(cipher.encrypt(text)) == text);
+    CHECK_THROW(cipher.encrypt(L"AB"), std::invalid_argument);
+    CHECK_EQUAL(cipher.encrypt(std::string_view("A😀中AA")), std::string("AA中中A"));
+}
+
+TEST(TestUtf8LettersOfAnyLength) {
+    // Буквы из одного, двух, трёх и четырёх байт в UTF-8.
+    const Alphabet mixed(L"A\u00E9\u4E2D\U0001F600");
+    const modPermutationCipher cipher(L"1379", mixed);
+    CHECK_EQUAL(cipher.utf8Capacity(10), 40u);
+    CHECK_EQUAL(modPermutationCipher(L"1").utf8Capacity(10), 20u);
+    std::mt19937 gen(25);
+    std::wstring text(100000, L' ');
+    for (auto& c : text) {
+        c = mixed.letter(gen() % mixed.size());
+    }
+    const std::string bytes = wstring_to_string(text);
+    const std::string expected = wstring_to_string(cipher.encrypt(text));
+    CHECK(cipher.encrypt(std::string_view(bytes)) == expected);
+    CHECK(cipher.decrypt(std::string_view(expected)) == bytes);
+
+    std::string parallel(cipher.utf8Capacity(bytes.size()), '\0');
+    size_t phase = 0;
+    parallel.resize(cipher.encryptParallel(bytes.data(), bytes.size(), &parallel[0], 3, phase));
+    CHECK(parallel == expected);
+    CHECK_EQUAL(phase, text.size() % 4);
+
+    // Фрагменты режутся посреди букв любой длины, в том числе по одному байту.
+    CipherStream<modPermutationCipher> encryptor(cipher, true);
+    std::string streamed;
+    for (size_t pos = 0; pos < bytes.size();) {
+        const size_t n = std::min<size_t>(gen() % 6, bytes.size() - pos);
+        streamed += encryptor.update(std::string_view(bytes).substr(pos, n));
+        pos += n;
+    }
+    CHECK_EQUAL(encryptor.finalize(), 0u);
+    CHECK(streamed == expected);
+
+    // Не байт продолжения после начала буквы — ошибка, начало буквы при этом сохраняется.
+    CipherStream<modPermutationCipher> broken(cipher, true);
+    CHECK_EQUAL(broken.update(std::string_view("\xF0\x9F")), std::string());
+    CHECK_THROW(broken.update(std::string_view("A")), std::invalid_argument);
+    CHECK_EQUAL(broken.update(std::string_view("\x98\x80")), std::string("A"));
+    broken.update(std::string_view("\xE4"));
+    CHECK_THROW(broken.finalize(), std::invalid_argument);
+}
+
+TEST(TestSharedInstanceConcurrentUse) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    std::mt19937 gen(7);
+    std::wstring text(3000, L' ');
+    for (auto& c : text) {
+        c = alphabet[gen() % alphabet.size()];
+    }
+    const modPermutationCipher cipher(L"90317");
+    const std::wstring expected = cipher.encrypt(text);
+    const std::string bytes = wstring_to_string(text);
+    const std::string expectedBytes = wstring_to_string(expected);
+    std::vector<int> failures(8, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 8; t++) {
+        workers.emplace_back([&, t] {
+            std::string out(2 * bytes.size(), '\0');
+            for (int i = 0; i < 200; i++) {
+                failures[t] += cipher.decrypt(cipher.encrypt(text)) != text;
+                size_t phase = 0;
+                out.resize(cipher.encrypt(bytes.data(), bytes.size(), &out[0], phase));
+                failures[t] += out != expectedBytes;
+                out.resize(2 * bytes.size());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    CHECK(failures == std::vector<int>(8, 0));
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}
@@ -0,0 +1,609 @@
+/**
+ * @file productCipher.h
+ * @author Бренинг И. А.
+ * @brief Составной шифр (произведение шифров): цепочка шифров лабораторных работ.
+ *
+ * @details
+ * Цепочка объявляется перечислением ступеней, например
+ * @code
+ * const Pipeline product{modAlphaCipher(L"КЛЮЧ"), modAlphakey(5)};
+ * @endcode
+ * Зашифрование применяет ступени слева направо, расшифрование — обратные
+ * преобразования справа налево.
+ *
+ * Ступени бывают двух видов (см. StageTraits): подстановки, сдвигающие каждую
+ * букву по ключу (BasicGronsfeld, modPermutationCipher), и маршрутная перестановка
+ * (modAlphakey). Подстановка, за которой сразу идёт перестановка, выполняется
+ * слиянием за один проход: столбец таблицы перестановки — это буквы открытого
+ * текста с шагом, равным ширине таблицы, и подстановка применяется прямо
+ * при сборе столбца (encryptStrided()). Расшифрование так же раскладывает
+ * столбец шифротекста по таблице, сразу снимая подстановку (decryptStrided()).
+ * Промежуточный текст между слитыми ступенями не записывается в память.
+ * Остальные ступени выполняются по очереди над общим буфером.
+ */
+
+#pragma once
+
+#include "modAlphakey.h"
+#include "modGronsfeld.h"
+#include "modPermutation.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Описание шифра как ступени цепочки.
+ *
+ * @details Для каждой ступени задаются:
+ * - `substitution` — шифр меняет буквы, не меняя их мест, и умеет шифровать
+ *   буквы, взятые с шагом (encryptStrided()/decryptStrided());
+ * - `transposition` — шифр переставляет символы по столбцам таблицы ширины `width()`;
+ * - encrypt()/decrypt() — преобразование буфера (`out` не совпадает с `in`,
+ *   кроме подстановок, которым совпадение разрешено).
+ *
+ * Новый шифр подключается к Pipeline специализацией этого шаблона.
+ *
+ * @tparam Cipher Класс шифра.
+ */
+template <class Cipher>
+struct StageTraits;
+
+/**
+ * @brief Шифр Гронсвельда — подстановка.
+ */
+template <class Alphabet>
+struct StageTraits<BasicGronsfeld<Alphabet>> {
+    static constexpr bool substitution = true;
+    static constexpr bool transposition = false;
+
+    static void encrypt(const BasicGronsfeld<Alphabet>& cipher, const wchar_t* in, size_t length, wchar_t* out) {
+        cipher.encrypt(in, length, out);
+    }
+
+    static void decrypt(const BasicGronsfeld<Alphabet>& cipher, const wchar_t* in, size_t length, wchar_t* out) {
+        cipher.decrypt(in, length, out);
+    }
+};
+
+/**
+ * @brief Шифр modPermutationCipher — подстановка (сдвиг по цифрам ключа).
+ */
+template <>
+struct StageTraits<modPermutationCipher> {
+    static constexpr bool substitution = true;
+    static constexpr bool transposition = false;
+
+    static void encrypt(const modPermutationCipher& cipher, const wchar_t* in, size_t length, wchar_t* out) {
+        check(cipher.tryEncrypt(in, length, out));
+    }
+
+    static void decrypt(const modPermutationCipher& cipher, const wchar_t* in, size_t length, wchar_t* out) {
+        check(cipher.tryDecrypt(in, length, out));
+    }
+
+    /**
+     * @brief Переводит код ошибки в исключение с тем же сообщением, что у самого шифра.
+     *
+     * @details Пустой текст ступень принимает (это одно из сообщений пакета), поэтому
+     * ошибка может быть только из-за символа не из алфавита: текст повторно не проверяется.
+     */
+    static void check(const CipherResult& result) {
+        if (!result) {
+            throw std::invalid_argument("Ошибка: текст должен содержать только буквы из заданного алфавита.");
+        }
+    }
+};
+
+/**
+ * @brief Маршрутная перестановка modAlphakey.
+ */
+template <>
+struct StageTraits<modAlphakey> {
+    static constexpr bool substitution = false;
+    static constexpr bool transposition = true;
+
+    static size_t width(const modAlphakey& cipher) { return cipher.width(); }
+
+    static void encrypt(const modAlphakey& cipher, const wchar_t* in, size_t length, wchar_t* out) {
+        cipher.encrypt(in, length, out);
+    }
+
+    static void decrypt(const modAlphakey& cipher, const wchar_t* in, size_t length, wchar_t* out) {
+        cipher.decrypt(in, length, out);
+    }
+};
+
+/**
+ * @class Pipeline
+ * @brief Произведение шифров: ступени применяются одна за другой.
+ *
+ * @details Объект неизменяем после создания, поэтому, как и сами шифры, его можно
+ * использовать из нескольких потоков одновременно.
+ *
+ * @tparam Stages Классы ступеней в порядке зашифрования.
+ */
+template <class... Stages>
+class Pipeline {
+    static_assert(sizeof...(Stages) > 0, "Pipeline needs at least one stage");
+
+private:
+    std::tuple<Stages...> stages; ///< Ступени в порядке зашифрования.
+
+    static constexpr size_t stageCount = sizeof...(Stages);
+
+    template <size_t I>
+    using Stage = std::tuple_element_t<I, std::tuple<Stages...>>;
+
+    template <size_t I>
+    using Traits = StageTraits<Stage<I>>;
+
+    /**
+     * @brief Сливаются ли ступени I и I + 1 в один проход.
+     */
+    template <size_t I>
+    static constexpr bool fused() {
+        if constexpr (I + 1 < stageCount) {
+            return Traits<I>::substitution && Traits<I + 1>::transposition;
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Сливаются ли при расшифровании ступени I - 2 и I - 1.
+     */
+    template <size_t I>
+    static constexpr bool fusedBefore() {
+        if constexpr (I >= 2) {
+            return fused<I - 2>();
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * @brief Буферы, между которыми переходит текст от ступени к ступени.
+     *
+     * @details Подстановка пишет результат на место входа, перестановка — в другой
+     * буфер. Запасной буфер выделяется только если он понадобился; в пакете он один
+     * на все сообщения и сразу выделяется под самое длинное из них.
+     */
+    struct Buffers {
+        const wchar_t* in = nullptr; ///< Исходный текст (не изменяется).
+        wchar_t* out = nullptr;      ///< Буфер результата.
+        size_t length = 0;           ///< Длина текста.
+        std::wstring spare;          ///< Запасной буфер для перестановок.
+        size_t spareLength = 0;      ///< Размер, под который выделяется запасной буфер.
+
+        /**
+         * @brief Переходит к следующему тексту, сохраняя запасной буфер.
+         */
+        void start(const wchar_t* text, size_t count, wchar_t* result) {
+            in = text;
+            out = result;
+            length = count;
+        }
+
+        /**
+         * @brief Буфер для ступени, меняющей буквы на месте.
+         */
+        wchar_t* inPlace(const wchar_t* src) {
+            return src == in ? out : const_cast<wchar_t*>(src);
+        }
+
+        /**
+         * @brief Буфер для ступени, которой нужен результат отдельно от входа.
+         */
+        wchar_t* other(const wchar_t* src) {
+            if (src != out) {
+                return out;
+            }
+            if (spare.size() < length) {
+                spare.resize(std::max(length, spareLength));
+            }
+            return &spare[0];
+        }
+    };
+
+    static constexpr size_t tileChars = 1 << 14; ///< Символов открытого текста в одном блоке слитого прохода.
+    static constexpr size_t tileRows = 16;       ///< Наименьшая высота блока (как в modAlphakey).
+
+    /**
+     * @brief Слитый проход: подстановка и маршрутная перестановка таблицы ширины `width`.
+     *
+     * @details Столбец c таблицы — символы открытого текста c, c + w, c + 2w, ...;
+     * столбцы идут в шифротекст справа налево, как в modAlphakey. Таблица обходится
+     * блоками строк: блок открытого текста остаётся в кэше, пока из него собираются
+     * отрезки всех столбцов, а позиция ключа подстановки — позиция символа
+     * в открытом тексте.
+     *
+     * @param forward true — сбор с зашифрованием, false — раскладка с расшифрованием.
+     */
+    template <class Substitution>
+    static void fusedPass(const Substitution& substitution, size_t width, const wchar_t* src, size_t length,
+                          wchar_t* dst, bool forward) {
+        const size_t rows = (length + width - 1) / width;
+        const size_t tile = std::max(tileRows, tileChars / width);
+        for (size_t r0 = 0; r0 < rows; r0 += tile) {
+            size_t x = 0; // начало столбца в шифротексте
+            for (size_t c = std::min(width, length); c-- > 0;) {
+                const size_t height = (length - c + width - 1) / width;
+                if (r0 < height) {
+                    const size_t count = std::min(height, r0 + tile) - r0;
+                    if (forward) {
+                        substitution.encryptStrided(src, r0 * width + c, width, count, dst + x + r0);
+                    } else {
+                        substitution.decryptStrided(src + x + r0, count, dst, r0 * width + c, width);
+                    }
+                }
+                x += height;
+            }
+        }
+    }
+
+    /**
+     * @brief Выполняет ступени начиная с I при зашифровании.
+     *
+     * @return const wchar_t* Буфер с результатом последней ступени.
+     */
+    template <size_t I>
+    const wchar_t* encryptFrom(const wchar_t* src, Buffers& buffers) const {
+        if constexpr (I == stageCount) {
+            return src;
+        } else if constexpr (fused<I>()) {
+            wchar_t* dst = buffers.other(src);
+            fusedPass(std::get<I>(stages), Traits<I + 1>::width(std::get<I + 1>(stages)), src, buffers.length,
+                      dst, true);
+            return encryptFrom<I + 2>(dst, buffers);
+        } else {
+            wchar_t* dst = Traits<I>::substitution ? buffers.inPlace(src) : buffers.other(src);
+            Traits<I>::encrypt(std::get<I>(stages), src, buffers.length, dst);
+            return encryptFrom<I + 1>(dst, buffers);
+        }
+    }
+
+    /**
+     * @brief Снимает ступени с номерами меньше I при расшифровании (справа налево).
+     *
+     * @return const wchar_t* Буфер с результатом первой ступени.
+     */
+    template <size_t I>
+    const wchar_t* decryptFrom(const wchar_t* src, Buffers& buffers) const {
+        if constexpr (I == 0) {
+            return src;
+        } else if constexpr (fusedBefore<I>()) {
+            wchar_t* dst = buffers.other(src);
+            fusedPass(std::get<I - 2>(stages), Traits<I - 1>::width(std::get<I - 1>(stages)), src, buffers.length,
+                      dst, false);
+            return decryptFrom<I - 2>(dst, buffers);
+        } else {
+            wchar_t* dst = Traits<I - 1>::substitution ? buffers.inPlace(src) : buffers.other(src);
+            Traits<I - 1>::decrypt(std::get<I - 1>(stages), src, buffers.length, dst);
+            return decryptFrom<I - 1>(dst, buffers);
+        }
+    }
+
+    /**
+     * @brief Шифрует текст, заданный в `buffers`, и кладёт результат в `buffers.out`.
+     */
+    void encryptText(Buffers& buffers) const {
+        const wchar_t* result = encryptFrom<0>(buffers.in, buffers);
+        if (result != buffers.out) {
+            std::memcpy(buffers.out, result, buffers.length * sizeof(wchar_t));
+        }
+    }
+
+    /**
+     * @brief Расшифровывает текст, заданный в `buffers`, и кладёт результат в `buffers.out`.
+     */
+    void decryptText(Buffers& buffers) const {
+        const wchar_t* result = decryptFrom<stageCount>(buffers.in, buffers);
+        if (result != buffers.out) {
+            std::memcpy(buffers.out, result, buffers.length * sizeof(wchar_t));
+        }
+    }
+
+    /**
+     * @brief Длина самого длинного сообщения пакета.
+     */
+    static size_t longestMessage(const size_t* offsets, size_t count) {
+        size_t longest = 0;
+        for (size_t i = 0; i < count; i++) {
+            longest = std::max(longest, offsets[i + 1] - offsets[i]);
+        }
+        return longest;
+    }
+
+    /**
+     * @brief Проверяет смещения пакета сообщений.
+     */
+    static void checkBatch(const MessageBatch& batch) {
+        if (batch.offsets.empty() || !std::is_sorted(batch.offsets.begin(), batch.offsets.end())
+            || batch.offsets.back() > batch.text.size()) {
+            throw std::invalid_argument("Invalid batch offsets");
+        }
+    }
+
+    friend class CipherStream<Pipeline>;
+
+public:
+    /**
+     * @brief Создаёт цепочку из готовых шифров.
+     *
+     * @param stages Ступени в порядке зашифрования.
+     */
+    explicit Pipeline(Stages... stages) : stages(std::move(stages)...) {}
+
+    /**
+     * @brief Ступень с номером I (для проверки и отладки).
+     */
+    template <size_t I>
+    const Stage<I>& stage() const {
+        return std::get<I>(stages);
+    }
+
+    /**
+     * @brief Шифрует текст в буфер вызывающей стороны.
+     *
+     * @param open_text Текст для шифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (не совпадает с `open_text`).
+     * @throws std::invalid_argument Если текст не подходит одной из ступеней.
+     */
+    void encrypt(const wchar_t* open_text, size_t length, wchar_t* out) const {
+        Buffers buffers;
+        buffers.start(open_text, length, out);
+        encryptText(buffers);
+    }
+
+    /**
+     * @brief Расшифровывает текст в буфер вызывающей стороны.
+     *
+     * @param cipher_text Текст для расшифрования.
+     * @param length Количество символов (допускается 0).
+     * @param out Буфер результата не меньше `length` символов (не совпадает с `cipher_text`).
+     * @throws std::invalid_argument Если текст не подходит одной из ступеней.
+     */
+    void decrypt(const wchar_t* cipher_text, size_t length, wchar_t* out) const {
+        Buffers buffers;
+        buffers.start(cipher_text, length, out);
+        decryptText(buffers);
+    }
+
+    /**
+     * @brief Шифрует текст.
+     *
+     * @param open_text Текст для шифрования.
+     * @return std::wstring Зашифрованный текст той же длины.
+     * @throws std::invalid_argument Если текст не подходит одной из ступеней.
+     */
+    std::wstring encrypt(const std::wstring& open_text) const {
+        std::wstring result(open_text.size(), L'\0');
+        encrypt(open_text.data(), open_text.size(), &result[0]);
+        return result;
+    }
+
+    /**
+     * @brief Расшифровывает текст.
+     *
+     * @param cipher_text Текст для расшифрования.
+     * @return std::wstring Расшифрованный текст той же длины.
+     * @throws std::invalid_argument Если текст не подходит одной из ступеней.
+     */
+    std::wstring decrypt(const std::wstring& cipher_text) const {
+        std::wstring result(cipher_text.size(), L'\0');
+        decrypt(cipher_text.data(), cipher_text.size(), &result[0]);
+        return result;
+    }
+
+    /**
+     * @brief Шифрует пакет сообщений; каждое сообщение шифруется отдельно.
+     *
+     * @details Как и в BasicGronsfeld::encryptBatch(), сообщение `i` занимает символы
+     * `[offsets[i], offsets[i + 1])`, результат пишется по тем же смещениям. Таблица
+     * перестановки строится для каждого сообщения своя, поэтому ключ подстановок
+     * всегда начинается заново. Сообщения проходят тот же слитый проход, что и
+     * отдельный текст, а запасной буфер выделяется один раз на весь пакет.
+     *
+     * @param text Сообщения подряд.
+     * @param offsets Границы сообщений: `count + 1` неубывающих смещений.
+     * @param count Количество сообщений.
+     * @param out Буфер результата не меньше `offsets[count]` символов (не совпадает с `text`).
+     * @throws std::invalid_argument Если какое-либо сообщение не подходит одной из ступеней.
+     */
+    void encryptBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out) const {
+        Buffers buffers;
+        buffers.spareLength = longestMessage(offsets, count);
+        for (size_t i = 0; i < count; i++) {
+            buffers.start(text + offsets[i], offsets[i + 1] - offsets[i], out + offsets[i]);
+            encryptText(buffers);
+        }
+    }
+
+    /**
+     * @brief Расшифровывает пакет сообщений; каждое сообщение расшифровывается отдельно.
+     *
+     * @param text Сообщения подряд.
+     * @param offsets Границы сообщений: `count + 1` неубывающих смещений.
+     * @param count Количество сообщений.
+     * @param out Буфер результата не меньше `offsets[count]` символов (не совпадает с `text`).
+     * @throws std::invalid_argument Если какое-либо сообщение не подходит одной из ступеней.
+     */
+    void decryptBatch(const wchar_t* text, const size_t* offsets, size_t count, wchar_t* out) const {
+        Buffers buffers;
+        buffers.spareLength = longestMessage(offsets, count);
+        for (size_t i = 0; i < count; i++) {
+            buffers.start(text + offsets[i], offsets[i + 1] - offsets[i], out + offsets[i]);
+            decryptText(buffers);
+        }
+    }
+
+    /**
+     * @brief Шифрует пакет сообщений и возвращает результат одним пакетом.
+     *
+     * @param batch Пакет сообщений.
+     * @return MessageBatch Зашифрованные сообщения с теми же смещениями.
+     * @throws std::invalid_argument Если смещения не согласованы с текстом или сообщение не подходит ступени.
+     */
+    MessageBatch encryptBatch(const MessageBatch& batch) const {
+        checkBatch(batch);
+        MessageBatch result{std::wstring(batch.text.size(), L'\0'), batch.offsets};
+        encryptBatch(batch.text.data(), batch.offsets.data(), batch.offsets.size() - 1, &result.text[0]);
+        return result;
+    }
+
+    /**
+     * @brief Расшифровывает пакет сообщений и возвращает результат одним пакетом.
+     *
+     * @param batch Пакет сообщений.
+     * @return MessageBatch Расшифрованные сообщения с теми же смещениями.
+     * @throws std::invalid_argument Если смещения не согласованы с текстом или сообщение не подходит ступени.
+     */
+    MessageBatch decryptBatch(const MessageBatch& batch) const {
+        checkBatch(batch);
+        MessageBatch result{std::wstring(batch.text.size(), L'\0'), batch.offsets};
+        decryptBatch(batch.text.data(), batch.offsets.data(), batch.offsets.size() - 1, &result.text[0]);
+        return result;
+    }
+};
+
+/**
+ * @brief Вывод типов ступеней из аргументов: `Pipeline{modAlphaCipher(L"КЛЮЧ"), modAlphakey(5)}`.
+ */
+template <class... Stages>
+Pipeline(Stages...) -> Pipeline<Stages...>;
+
+/**
+ * @class CipherStream<Pipeline<Stages...>>
+ * @brief Потоковый контекст составного шифра: потоковые контексты ступеней по цепочке.
+ *
+ * @details Фрагмент проходит через контексты ступеней по порядку (при расшифровании —
+ * в обратном порядке), выход одной ступени сразу подаётся следующей. Перестановка
+ * задерживает весь текст до finalize() (см. CipherStream<modAlphakey>), поэтому
+ * ступени после неё получают текст только в finalize(). Фрагменты обрабатываются
+ * на месте в буфере результата, без промежуточных копий.
+ *
+ * @tparam Stages Классы ступеней.
+ */
+template <class... Stages>
+class CipherStream<Pipeline<Stages...>> {
+private:
+    std::tuple<CipherStream<Stages>...> streams; ///< Контексты ступеней в порядке зашифрования.
+    bool forward;                                ///< true — зашифрование, false — расшифрование.
+
+    static constexpr size_t stageCount = sizeof...(Stages);
+
+    /**
+     * @brief Контекст ступени с номером I в порядке обработки.
+     */
+    template <size_t I>
+    auto& stream() {
+        return std::get<I>(streams);
+    }
+
+    /**
+     * @brief Подаёт текст в ступени с K-й по порядку обработки; возвращает длину результата.
+     */
+    template <size_t K>
+    size_t updateFrom(const wchar_t* in, size_t length, wchar_t* out) {
+        if constexpr (K == stageCount) {
+            if (in != out) {
+                std::memcpy(out, in, length * sizeof(wchar_t));
+            }
+            return length;
+        } else {
+            const size_t written = forward ? stream<K>().update(in, length, out)
+                                           : stream<stageCount - 1 - K>().update(in, length, out);
+            return updateFrom<K + 1>(out, written, out);
+        }
+    }
+
+    /**
+     * @brief Завершает ступени с K-й по порядку обработки.
+     *
+     * @param out Буфер, в котором лежат `written` символов, ещё не поданных K-й ступени.
+     */
+    template <size_t K>
+    size_t finalizeFrom(wchar_t* out, size_t written) {
+        if constexpr (K == stageCount) {
+            return written;
+        } else {
+            auto finish = [&](auto& s) {
+                const size_t passed = s.update(out, written, out);
+                return passed + s.finalize(out + passed);
+            };
+            return finalizeFrom<K + 1>(out, forward ? finish(stream<K>()) : finish(stream<stageCount - 1 - K>()));
+        }
+    }
+
+    template <size_t... I>
+    CipherStream(const Pipeline<Stages...>& cipher, bool forward, std::index_sequence<I...>)
+        : streams(CipherStream<Stages>(std::get<I>(cipher.stages), forward)...), forward(forward) {}
+
+public:
+    /**
+     * @brief Создаёт потоковый контекст для зашифрования или расшифрования.
+     *
+     * @param cipher Составной шифр (копируется вместе со ступенями).
+     * @param forward true — зашифрование, false — расшифрование.
+     */
+    CipherStream(const Pipeline<Stages...>& cipher, bool forward)
+        : CipherStream(cipher, forward, std::index_sequence_for<Stages...>()) {}
+
+    /**
+     * @brief Обрабатывает фрагмент в буфер.
+     *
+     * @param in Фрагмент.
+     * @param length Количество символов.
+     * @param out Буфер не меньше `length` символов (может совпадать с `in`).
+     * @return size_t Количество записанных символов (не больше `length`).
+     * @throws std::invalid_argument Если фрагмент не подходит одной из ступеней.
+     */
+    size_t update(const wchar_t* in, size_t length, wchar_t* out) {
+        if (length == 0) {
+            return 0;
+        }
+        const size_t written = forward ? stream<0>().update(in, length, out)
+                                       : stream<stageCount - 1>().update(in, length, out);
+        return updateFrom<1>(out, written, out);
+    }
+
+    /**
+     * @brief Обрабатывает фрагмент и возвращает готовую часть результата.
+     */
+    std::wstring update(const std::wstring& fragment) {
+        std::wstring result(fragment.size(), L'\0');
+        result.resize(update(fragment.data(), fragment.size(), &result[0]));
+        return result;
+    }
+
+    /**
+     * @brief Количество символов, которое допишет finalize(): сумма задержанного ступенями.
+     */
+    size_t pending() const {
+        return std::apply([](const auto&... s) { return (s.pending() + ...); }, streams);
+    }
+
+    /**
+     * @brief Дописывает задержанные символы и готовит контекст к следующему тексту.
+     *
+     * @param out Буфер не меньше pending() символов.
+     * @return size_t Количество записанных символов.
+     */
+    size_t finalize(wchar_t* out) {
+        return finalizeFrom<0>(out, 0);
+    }
+
+    /**
+     * @brief Дописывает задержанные символы и возвращает их строкой.
+     */
+    std::wstring finalize() {
+        std::wstring result(pending(), L'\0');
+        result.resize(finalize(&result[0]));
+        return result;
+    }
+};
@@ -0,0 +1,109 @@
+#include <UnitTest++/UnitTest++.h>
+#include "productCipher.h"
+#include <random>
+
+namespace {
+
+/**
+ * @brief Случайный текст из заглавных русских букв.
+ */
+std::wstring randomRussian(size_t length, unsigned seed) {
+    const std::wstring alphabet = L"АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ";
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> letter(0, alphabet.size() - 1);
+    std::wstring text(length, L'\0');
+    for (wchar_t& c : text) {
+        c = alphabet[letter(gen)];
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(TestFusedMatchesSeparateStages) {
+    const modAlphaCipher gronsfeld(L"ШИФР");
+    const modPermutationCipher permutation(L"31415");
+    // Длины вокруг границы, после которой modAlphakey переставляет блоками, а не по маршруту.
+    for (size_t length : {1u, 2u, 7u, 100u, 1001u, 70001u}) {
+        const std::wstring text = randomRussian(length, static_cast<unsigned>(length));
+        for (int width : {1, 3, 8, 150}) {
+            const modAlphakey route(width);
+            const Pipeline product{gronsfeld, route};
+            const std::wstring expected = route.encrypt(gronsfeld.encrypt(text));
+            CHECK(product.encrypt(text) == expected);
+            CHECK(product.decrypt(expected) == text);
+
+            // Сдвиг modPermutationCipher может дать латинскую букву, поэтому он последний.
+            const Pipeline three{route, gronsfeld, permutation};
+            const std::wstring threeExpected = permutation.encrypt(gronsfeld.encrypt(route.encrypt(text)));
+            CHECK(three.encrypt(text) == threeExpected);
+            CHECK(three.decrypt(threeExpected) == text);
+        }
+    }
+}
+
+TEST(TestSubstitutionOnlyPipeline) {
+    const modAlphaCipher first(L"КЛЮЧ");
+    const modAlphaCipher second(L"ДРУГОЙ");
+    const Pipeline product{first, second};
+    const std::wstring text = randomRussian(1000, 7);
+    CHECK(product.encrypt(text) == second.encrypt(first.encrypt(text)));
+    CHECK(product.decrypt(product.encrypt(text)) == text);
+}
+
+TEST(TestPipelineInvalidText) {
+    const Pipeline gronsfeld{modAlphaCipher(L"КЛЮЧ"), modAlphakey(4)};
+    CHECK_THROW(gronsfeld.encrypt(L"ПРИВЕТМИР1"), std::invalid_argument);
+    CHECK_THROW(gronsfeld.decrypt(L"ПРИВЕТ МИР"), std::invalid_argument);
+    const Pipeline permutation{modAlphakey(3), modPermutationCipher(L"12")};
+    CHECK_THROW(permutation.encrypt(L"ПРИВЕТ!"), std::invalid_argument);
+}
+
+TEST(TestPipelineBatchMatchesSingleMessages) {
+    const Pipeline product{modAlphaCipher(L"ШИФР"), modAlphakey(3)};
+    const std::vector<std::wstring> messages = {L"ПРИВЕТ", L"", L"А", L"ШИФРОВАНИЕСООБЩЕНИЙ"};
+    MessageBatch batch{std::wstring(), {0}};
+    for (const std::wstring& message : messages) {
+        batch.text += message;
+        batch.offsets.push_back(batch.text.size());
+    }
+    const MessageBatch encrypted = product.encryptBatch(batch);
+    for (size_t i = 0; i < messages.size(); i++) {
+        const std::wstring part = encrypted.text.substr(batch.offsets[i], batch.offsets[i + 1] - batch.offsets[i]);
+        CHECK(part == product.encrypt(messages[i]));
+    }
+    CHECK(product.decryptBatch(encrypted).text == batch.text);
+    CHECK_THROW(product.encryptBatch(MessageBatch{L"АБ", {0, 3}}), std::invalid_argument);
+
+    // Вторая перестановка пишет в запасной буфер, общий для всех сообщений пакета.
+    const Pipeline spare{modAlphakey(3), modAlphaCipher(L"КЛЮЧ"), modAlphakey(4), modPermutationCipher(L"58")};
+    const MessageBatch twice = spare.encryptBatch(batch);
+    for (size_t i = 0; i < messages.size(); i++) {
+        const std::wstring part = twice.text.substr(batch.offsets[i], batch.offsets[i + 1] - batch.offsets[i]);
+        CHECK(part == spare.encrypt(messages[i]));
+    }
+    CHECK(spare.decryptBatch(twice).text == batch.text);
+    CHECK_THROW(spare.encryptBatch(MessageBatch{L"ПРИВЕТ!", {0, 7}}), std::invalid_argument);
+}
+
+TEST(TestPipelineStreamMatchesWholeText) {
+    const Pipeline product{modAlphaCipher(L"ШИФР"), modAlphakey(5), modPermutationCipher(L"271")};
+    const std::wstring text = randomRussian(5000, 11);
+    const std::wstring expected = product.encrypt(text);
+    for (bool forward : {true, false}) {
+        const std::wstring& input = forward ? text : expected;
+        CipherStream<Pipeline<modAlphaCipher, modAlphakey, modPermutationCipher>> stream(product, forward);
+        std::wstring result;
+        for (size_t pos = 0; pos < input.size(); pos += 777) {
+            result += stream.update(input.substr(pos, 777));
+        }
+        CHECK_EQUAL(input.size() - result.size(), stream.pending());
+        result += stream.finalize();
+        CHECK(result == (forward ? expected : text));
+        CHECK_EQUAL(0u, stream.pending());
+    }
+}
+
+int main() {
+    return UnitTest::RunAllTests();
+}